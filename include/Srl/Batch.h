@@ -0,0 +1,56 @@
+#ifndef SRL_BATCH_H
+#define SRL_BATCH_H
+
+#include "In.h"
+#include "Out.h"
+
+#include <functional>
+#include <vector>
+
+namespace Srl {
+
+    /* Independent objects are stored and restored on a pool of n_threads workers,
+     * n_threads = 0 uses all cores. Each worker keeps one Tree and one parser for all
+     * the objects it handles. Results are in the order of the input range. */
+
+    /* one buffer per object */
+    template<class TParser, class Range>
+    std::vector<std::vector<uint8_t>> store_batch (const Range& objects, size_t n_threads = 0);
+
+    /* all objects framed into a single stream, each one prefixed by its size as 64 bit little endian integer */
+    template<class TParser, class Range>
+    void store_batch_framed (const Range& objects, Lib::Out::Source out, size_t n_threads = 0);
+
+    /* restore each source of a range of buffers into the object at the same position */
+    template<class TParser, class Sources, class Objects>
+    void restore_batch (const Sources& sources, Objects& objects, size_t n_threads = 0);
+
+    template<class Object, class TParser, class Sources>
+    std::vector<Object> restore_batch (const Sources& sources, size_t n_threads = 0);
+
+    /* restore a stream of framed objects as written by store_batch_framed */
+    template<class Object, class TParser>
+    std::vector<Object> restore_batch_framed (const uint8_t* data, size_t size, size_t n_threads = 0);
+
+    /* restore the elements of a single top level array in parallel, which must be objects or arrays.
+     * Sources read from streams, parsers which can't resume reading and elements holding shared pointers,
+     * which may point into other elements, are restored serially. */
+    template<class Object, class TParser>
+    std::vector<Object> restore_parallel (Lib::In::Source source, size_t n_threads = 0);
+
+    namespace Lib {
+
+        /* Calls fnc(worker, index) for each index in [0, count). Every worker starts on its own
+         * share of the indices, workers running out of work steal half of the indices another worker
+         * has left. The first exception thrown stops all workers and is rethrown to the caller. */
+        void parallel_for (size_t count, size_t n_threads, const std::function<void(size_t, size_t)>& fnc);
+
+        size_t batch_threads (size_t n_threads, size_t count);
+        /* number of consecutive runs count elements are split in, to be stolen by idle threads */
+        size_t batch_chunks  (size_t n_threads, size_t count);
+
+        std::vector<Lib::MemBlock> split_frames (const uint8_t* data, size_t size);
+    }
+}
+
+#endif
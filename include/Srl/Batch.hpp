@@ -0,0 +1,166 @@
+#ifndef SRL_BATCH_HPP
+#define SRL_BATCH_HPP
+
+#include "Batch.h"
+#include "Tree.hpp"
+
+#include <atomic>
+#include <iterator>
+
+namespace Srl {
+
+    namespace Lib { namespace Aux {
+
+        template<class Range>
+        auto range_begin(const Range& range)
+        {
+            typedef decltype(std::begin(range)) I;
+            static_assert(std::is_base_of<std::random_access_iterator_tag,
+                                          typename std::iterator_traits<I>::iterator_category>::value,
+                "Srl error. Batches require ranges with random access iterators.");
+
+            return std::begin(range);
+        }
+    } }
+
+    template<class TParser, class Range>
+    std::vector<std::vector<uint8_t>> store_batch (const Range& objects, size_t n_threads)
+    {
+        auto begin = Lib::Aux::range_begin(objects);
+        size_t count = std::distance(begin, std::end(objects));
+
+        n_threads = Lib::batch_threads(n_threads, count);
+
+        std::vector<std::vector<uint8_t>> sources(count);
+        std::vector<Tree>    trees(n_threads);
+        std::vector<TParser> parsers(n_threads);
+
+        Lib::parallel_for(count, n_threads, [&](size_t worker, size_t idx) {
+            trees[worker].store(*(begin + idx), sources[idx], parsers[worker]);
+        });
+
+        return sources;
+    }
+
+    template<class TParser, class Range>
+    void store_batch_framed (const Range& objects, Lib::Out::Source out, size_t n_threads)
+    {
+        auto sources = store_batch<TParser>(objects, n_threads);
+
+        Lib::Out frames;
+        frames.set(out);
+
+        for(auto& source : sources) {
+            uint64_t size = source.size();
+            for(auto i = 0U; i < sizeof(size); i++) {
+                frames.write_byte((size >> (i * 8)) & 0xFF);
+            }
+            frames.write(Lib::MemBlock(source.data(), source.size()));
+        }
+
+        frames.flush();
+    }
+
+    template<class TParser, class Sources, class Objects>
+    void restore_batch (const Sources& sources, Objects& objects, size_t n_threads)
+    {
+        auto src_begin = Lib::Aux::range_begin(sources);
+        auto obj_begin = std::begin(objects);
+        size_t count = std::distance(src_begin, std::end(sources));
+
+        if(count != (size_t)std::distance(obj_begin, std::end(objects))) {
+            throw Exception("Unable to restore batch. Number of sources and objects differ.");
+        }
+
+        n_threads = Lib::batch_threads(n_threads, count);
+
+        std::vector<Tree>    trees(n_threads);
+        std::vector<TParser> parsers(n_threads);
+
+        Lib::parallel_for(count, n_threads, [&](size_t worker, size_t idx) {
+            trees[worker].restore(*(obj_begin + idx), Lib::In::Source(*(src_begin + idx)), parsers[worker]);
+        });
+    }
+
+    template<class Object, class TParser, class Sources>
+    std::vector<Object> restore_batch (const Sources& sources, size_t n_threads)
+    {
+        std::vector<Object> objects;
+        objects.reserve(std::distance(std::begin(sources), std::end(sources)));
+
+        for(auto itr = std::begin(sources); itr != std::end(sources); itr++) {
+            objects.push_back(Ctor<Object>::Create());
+        }
+
+        restore_batch<TParser>(sources, objects, n_threads);
+
+        return objects;
+    }
+
+    template<class Object, class TParser>
+    std::vector<Object> restore_batch_framed (const uint8_t* data, size_t size, size_t n_threads)
+    {
+        auto frames = Lib::split_frames(data, size);
+        std::vector<Lib::In::Source> sources;
+        sources.reserve(frames.size());
+
+        for(auto& frame : frames) {
+            sources.emplace_back(frame.ptr, frame.size);
+        }
+
+        return restore_batch<Object, TParser>(sources, n_threads);
+    }
+
+    template<class Object, class TParser>
+    std::vector<Object> restore_parallel (Lib::In::Source source, size_t n_threads)
+    {
+        static_assert(TpTools::is_scope(Lib::Switch<Object>::type),
+            "Srl error. Elements restored in parallel have to be objects or arrays.");
+
+        TParser scan_parser;
+
+        if(source.is_stream || !scan_parser.resumes()) {
+            return Tree().restore<std::vector<Object>>(source, scan_parser);
+        }
+
+        Tree scanner;
+        auto splits = scanner.scan_array(scan_parser, source.block);
+        auto count  = splits.size() - 1;
+
+        std::vector<Object> objects;
+        objects.reserve(count);
+        for(auto i = 0U; i < count; i++) {
+            objects.push_back(Ctor<Object>::Create());
+        }
+
+        n_threads = Lib::batch_threads(n_threads, count);
+        auto n_chunks = Lib::batch_chunks(n_threads, count);
+
+        std::vector<Tree>    trees(n_threads);
+        std::vector<TParser> parsers(n_threads);
+        std::atomic<bool>    shared_ptrs { false };
+
+        Lib::parallel_for(n_chunks, n_threads, [&](size_t worker, size_t chunk) {
+            auto first = count * chunk / n_chunks;
+            auto last  = count * (chunk + 1) / n_chunks;
+            auto& tree = trees[worker];
+
+            tree.resume_source(parsers[worker], source.block, scanner, splits, first, last);
+
+            for(auto i = first; i < last && !shared_ptrs; i++) {
+                if(!tree.restore_element(Lib::Aux::TypeSwitch<Object>::Restore(tree, objects[i]))) {
+                    shared_ptrs = true;
+                }
+            }
+        });
+
+        /* pointees are shared across elements by the order they were stored in */
+        if(shared_ptrs) {
+            return Tree().restore<std::vector<Object>>(source, TParser());
+        }
+
+        return objects;
+    }
+}
+
+#endif
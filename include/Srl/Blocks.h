@@ -25,10 +25,12 @@ namespace Srl { namespace Lib {
         struct PackedBlock {
 
             PackedBlock(uint32_t sz, Type type_, Encoding encoding_)
-                : ui64(0), size(sz), type(type_), encoding(encoding_) { }
+                : ui64(0), size(sz), type(type_), encoding(encoding_),
+                  stored_local(false), borrowed(false), type_id(false) { }
 
             PackedBlock(const Lib::MemBlock& block, Type type_, Encoding encoding_)
-                : extern_data(block.ptr), size(block.size), type(type_), encoding(encoding_) { }
+                : extern_data(block.ptr), size(block.size), type(type_), encoding(encoding_),
+                  stored_local(false), borrowed(false), type_id(false) { }
 
             union {
                 uint8_t        local_data[8];
@@ -42,7 +44,10 @@ namespace Srl { namespace Lib {
             uint32_t size;
             Type     type;
             Encoding encoding;
-            bool     stored_local = false;
+            bool     stored_local : 1;
+            bool     borrowed     : 1; /* data points into the parsed source */
+            bool     type_id      : 1; /* polymorphic type id, see Value::as_type_id */
+            Type     elem_type    = Type::Null; /* element type of packed scalar arrays */
 
             const uint8_t* data() const
             {
@@ -10,5 +10,7 @@
 #include <vector>
 #include <functional>
 
+#include "Stats.h"
+
 
 #endif
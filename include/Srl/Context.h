@@ -3,6 +3,7 @@
 
 #include "Common.h"
 #include "Enums.h"
+#include "Fields.h"
 
 namespace Srl {
 
@@ -28,6 +29,8 @@ namespace Srl {
         Context& operator () (T&& o);
         template<class T>
         Context& operator () (const String& name, T&& o, uint64_t flags = CtxFlags::None);
+        template<class T>
+        Context& operator () (const Key& key, T&& o, uint64_t flags = CtxFlags::None);
 
         Node& node() const { return *this->context_node; }
         Mode  mode() const { return this->context_mode; }
@@ -41,6 +44,9 @@ namespace Srl {
 
         template<class T> void insert (const T& o, const String& name, uint64_t flags);
         template<class T> void paste  (T& o, const String& name, uint64_t flags);
+        template<class T> void paste  (T& o, const Key& key, uint64_t flags);
+
+        template<class T> bool has_field (const String& name);
     };
 
 
@@ -52,6 +58,8 @@ namespace Srl {
         StoreContext& operator () (const T& o);
         template<class T>
         StoreContext& operator () (const String& name, const T& o, uint64_t flags = CtxFlags::None);
+        template<class T>
+        StoreContext& operator () (const Key& key, const T& o, uint64_t flags = CtxFlags::None);
 
     private:
         Context context;
@@ -65,6 +73,8 @@ namespace Srl {
         RestoreContext& operator () (T&& o);
         template<class T>
         RestoreContext& operator () (const String& name, T&& o, uint64_t flags = CtxFlags::None);
+        template<class T>
+        RestoreContext& operator () (const Key& key, T&& o, uint64_t flags = CtxFlags::None);
 
     private:
         Context context;
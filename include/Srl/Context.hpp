@@ -33,6 +33,20 @@ namespace Srl {
         return *this;
     }
 
+    template<class T>
+    StoreContext& StoreContext::operator () (const Key& key, const T& o, uint64_t flags)
+    {
+        this->context.insert(o, key, flags);
+        return *this;
+    }
+
+    template<class T>
+    RestoreContext& RestoreContext::operator () (const Key& key, T&& o, uint64_t flags)
+    {
+        this->context.paste(o, key, flags);
+        return *this;
+    }
+
     template<class T>
     Context& Context::operator () (T&& o)
     {
@@ -52,6 +66,19 @@ namespace Srl {
         return *this;
     }
 
+    template<class T>
+    Context& Context::operator () (const Key& key, T&& o, uint64_t flags)
+    {
+        if(this->context_mode == Mode::Insert) {
+            this->insert(o, key, flags);
+
+        } else {
+            this->paste(o, key, flags);
+        }
+
+        return *this;
+    }
+
     template<class T>
     void Context::insert(const T& o, const String& name, uint64_t)
     {
@@ -64,15 +91,8 @@ namespace Srl {
         auto type   = Lib::Switch<T>::type;
         auto& index = TpTools::is_scope(type) ? this->nodes_index : this->values_index;
 
-        if((flags & CtxFlags::Optional)) {
-
-            bool has = TpTools::is_scope(type)
-                ? context_node->has_node(name)
-                : context_node->has_value(name);
-
-            if(!has) {
-                return;
-            }
+        if((flags & CtxFlags::Optional) && !this->has_field<T>(name)) {
+            return;
         }
 
         if(name.size() > 0) {
@@ -84,6 +104,24 @@ namespace Srl {
 
         index += 1;
     }
+
+    template<class T>
+    void Context::paste(T& o, const Key& key, uint64_t flags)
+    {
+        if((flags & CtxFlags::Optional) && !this->has_field<T>(key)) {
+            return;
+        }
+
+        this->context_node->paste_field(key, o);
+    }
+
+    template<class T>
+    bool Context::has_field(const String& name)
+    {
+        return TpTools::is_scope(Lib::Switch<T>::type)
+            ? this->context_node->has_node(name)
+            : this->context_node->has_value(name);
+    }
 }
 
 #endif
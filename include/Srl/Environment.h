@@ -5,10 +5,12 @@
 #include "String.h"
 #include "Hash.h"
 #include "Parser.h"
+#include "Pipeline.h"
 #include "In.h"
 #include "Out.h"
 
 #include <list>
+#include <memory_resource>
 
 namespace Srl {
 
@@ -23,11 +25,56 @@ namespace Lib {
 
         Link(size_t hash_, const T& field_)
             : hash(hash_), field(field_) { }
+
+        Link(size_t hash_, T&& field_)
+            : hash(hash_), field(std::move(field_)) { }
     };
 
     template<class T>
     using Items = std::list<Lib::Link<T>, Lib::HeapAllocator<Lib::Link<T>>>;
 
+    /* link last accessed by index, so walking a list by index is linear.
+     * Copies start out unset, the owning node unsets it on every erase. */
+    template<class T> struct Cursor {
+        Cursor() { }
+        Cursor(const Cursor&) { }
+        Cursor& operator= (const Cursor&) { this->set = false; return *this; }
+
+        typename Items<T>::iterator itr;
+        size_t index = 0;
+        bool   set   = false;
+    };
+
+    /* Buffered links by name hash, built once a node buffers more than Min_Links fields so fields restored
+     * in any order are found in constant time. Links are only appended, each lookup takes in the links past
+     * the indexed ones. Copies start out empty, the owning node clears it on every erase not done through it. */
+    template<class T> struct LinkIndex {
+        LinkIndex() { }
+        LinkIndex(const LinkIndex&) { }
+        LinkIndex& operator= (const LinkIndex&) { this->reset(); return *this; }
+
+        static const size_t Min_Links = 8;
+
+        enum class State : uint8_t { Empty, Used, Deleted };
+
+        struct Slot {
+            typename Items<T>::iterator itr;
+            size_t hash;
+            State  state;
+        };
+
+        /* slots are taken from the heap of the owning node */
+        Slot*  slots   = nullptr;
+        size_t cap     = 0;
+        size_t indexed = 0;
+        size_t deleted = 0;
+        bool   built   = false;
+
+        void clear() { this->built = false; }
+        /* drops the slots without giving them back, for when the node changes heaps */
+        void reset() { this->slots = nullptr; this->cap = 0; this->built = false; }
+    };
+
 
     template<> struct HashSrl<const void*> {
         size_t operator()(const void* v) const
@@ -39,10 +86,17 @@ namespace Lib {
 
     struct Environment {
 
-        static const String EmptyString;
+        static const String   EmptyString;
+        static const MemBlock TypeIdName;
         static const Encoding Str_Encoding = Encoding::UTF8;
 
-        Environment(Tree& tree_) : tree(&tree_) { }
+        Environment(Tree& tree_) : tree(&tree_)
+        {
+            /* growing tables don't stall a parse or store */
+            this->str_table.incremental_rehash();
+            this->shared_table_store.incremental_rehash();
+            this->shared_table_restore.incremental_rehash();
+        }
 
         Tree*                  tree;
         Heap                   heap;
@@ -54,8 +108,26 @@ namespace Lib {
         std::vector<uint8_t>  str_buffer;
         std::vector<uint8_t>  type_buffer;
 
-        Parser*   parser  = nullptr;
+        Parser*         parser   = nullptr;
+        const Pipeline* pipeline = nullptr;
         bool      parsing = false;
+        /* restore into existing objects instead of replacing them */
+        bool      reuse_objects = false;
+        /* memory resource for objects created while restoring, nullptr for the default heap */
+        std::pmr::memory_resource* resource = nullptr;
+        /* values borrowed from the source aren't copied while restoring */
+        bool      borrow_source = false;
+        /* borrowed values buffered in the tree, copied by release_source */
+        size_t    borrowed_kept = 0;
+
+        /* parsers interning type ids write those of polymorphic objects as indices into a per-document
+         * dictionary, the id string only appears on its first occurrence */
+        bool                                    intern_type_ids = false;
+        HTable<String, uint32_t>                type_ids_out { 16 };
+        std::vector<std::pair<String, size_t>>  type_ids_in;
+        /* read ids outlive clearing the heap, elements of a top level array read one by one share them */
+        Heap                                    type_ids_heap;
+
         Lib::In   in;
         Lib::Out  out;
 
@@ -64,20 +136,44 @@ namespace Lib {
         Link<Node>*  create_node (Type type, const String& name);
         Link<Node>*  store_node  (Node& parent, const Node& node,  const String& name);
         Link<Value>* store_value (Node& parent, const Value& value, const String& name);
+        Link<Node>*  store_array (Node& parent, const Value& array, const String& name);
 
         uint64_t     hash_string  (const String& str);
         String       conv_string  (const String& str);
 
-        void write      (const Value& value, const String& name);
-        void write_conv (const Value& value, const String& name);
-        Value conv_type (const Value& value);
+        /* through the pipeline of the parser in use */
+        std::pair<MemBlock, Value> read ();
+        void write (const Value& value, const String& name);
+
+        /* defined in Pipeline.hpp */
+        template<class TParser>
+        std::pair<MemBlock, Value> read (TParser& parser_);
+
+        template<class TParser>
+        void write         (TParser& parser_, const Value& value, const String& name);
+        template<class TParser>
+        void write_type_id (TParser& parser_, const Value& type_id, const String& name);
+        template<class TParser>
+        void write_elems   (TParser& parser_, const Value& array, const String& name);
+        template<class TParser>
+        void write_conv    (TParser& parser_, const Value& value, const String& name);
+
+        size_t type_slot (const Value& type_id);
+        String type_name (const Value& type_id);
+
+        void  read_type_id (const Value& type_id);
+        Value conv_type    (const Value& value);
 
         void set_output (Parser& parser, Lib::Out::Source src);
         void set_input  (Parser& parser, Lib::In::Source src);
 
         std::pair<const String*, size_t> store_string (const String& str);
 
-        void clear();
+        /* ends borrowing, values of the tree still pointing into the source are copied */
+        void release_source (Node& root);
+        void own_values     (Node& node);
+
+        void clear(size_t keep_bytes = Heap::Keep_All);
 
     };
 } }
@@ -0,0 +1,249 @@
+#ifndef SRL_FIELDS_H
+#define SRL_FIELDS_H
+
+#include "Common.h"
+#include "Hash.h"
+
+#include <array>
+#include <tuple>
+#include <utility>
+
+namespace Srl {
+
+    class Node;
+    class Value;
+    class Context;
+
+    /* Field name with a hash computed at compile time, use it in place of
+     * a string literal to save hashing names on every restore:
+     *
+     *     ctx (Srl::Key("name"), name);
+     */
+    class Key {
+
+    public:
+        template<size_t N>
+        constexpr explicit Key(const char (&str)[N]) : Key(str, N - 1) { }
+
+        constexpr Key(const char* str, size_t nchars_)
+            : chars(str), nchars(nchars_), hsh(Lib::Aux::hash_literal(str, nchars_)) { }
+
+        constexpr const char* c_str() const { return this->chars;  }
+        constexpr size_t      size()  const { return this->nchars; }
+        constexpr uint64_t    hash()  const { return this->hsh;    }
+
+        const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(this->chars); }
+
+        constexpr bool operator== (const Key& o) const
+        {
+            if(this->hsh != o.hsh || this->nchars != o.nchars) {
+                return false;
+            }
+            for(auto i = 0U; i < this->nchars; i++) {
+                if(this->chars[i] != o.chars[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        const char* chars;
+        size_t      nchars;
+        uint64_t    hsh;
+    };
+
+namespace Lib {
+
+    struct MemBlock;
+
+    template<class C, class M> struct Field {
+        Key    key;
+        M C::* member;
+    };
+
+    template<class C, class M>
+    constexpr Field<C, M> make_field(const Key& key, M C::* member)
+    {
+        return Field<C, M> { key, member };
+    }
+
+    /* Collision free mapping of a fixed set of keys to their index, the seed
+     * is searched at compile time. Lookups are a multiply, a shift and one
+     * compare of the name. */
+    template<size_t N> class PerfectHash {
+
+    public:
+        constexpr PerfectHash(const std::array<Key, N>& keys_);
+
+        /* index of the key or N if not found */
+        size_t find(const uint8_t* name, size_t nbytes, uint64_t hash) const;
+
+        constexpr bool valid() const { return this->seed != 0; }
+
+    private:
+        static constexpr size_t bits_for(size_t n) { return n < 2 ? 0 : 1 + bits_for((n + 1) / 2); }
+
+        static constexpr size_t Bits  = N < 2 ? 4 : bits_for(N * 8);
+        static constexpr size_t Slots = (size_t)1 << Bits;
+
+        std::array<Key, N>          keys;
+        std::array<uint8_t, Slots>  slots;
+        uint64_t                    seed;
+
+        constexpr size_t slot(uint64_t hash, uint64_t seed_) const
+        {
+            return ((hash ^ seed_) * 0x9E3779B97F4A7C15) >> (64 - Bits);
+        }
+    };
+
+    /* Compile-time table of the members listed in SRL_FIELDS. Stores fields like
+     * a plain srl_resolve would, on restore incoming fields are dispatched to
+     * their members by index instead of being looked up by name. */
+    template<class T> struct FieldTable {
+
+        static void Resolve(T& o, Context& ctx);
+
+    private:
+        static constexpr auto fields = T::srl_fields();
+        static constexpr size_t Size = std::tuple_size<typename std::decay<decltype(fields)>::type>::value;
+
+        static_assert(Size < 255, "Srl error. Too many fields in SRL_FIELDS.");
+
+        enum class Kind : uint8_t { Value, Scope, Other };
+
+        typedef void (*Setter)(T& o, Node& node, const Value& value);
+
+        template<size_t... I>
+        static constexpr std::array<Key, Size> make_keys(std::index_sequence<I...>)
+        {
+            return {{ std::get<I>(fields).key... }};
+        }
+
+        template<size_t... I>
+        static constexpr std::array<Setter, Size> make_setters(std::index_sequence<I...>)
+        {
+            return {{ &FieldTable::template set<I>... }};
+        }
+
+        template<size_t... I>
+        static constexpr std::array<Kind, Size> make_kinds(std::index_sequence<I...>)
+        {
+            return {{ kind_of<typename std::remove_reference<decltype(std::declval<T&>().*(std::get<I>(fields).member))>::type>()... }};
+        }
+
+        template<class M> static constexpr Kind kind_of();
+
+        static constexpr std::array<Key, Size>    keys    = make_keys(std::make_index_sequence<Size>());
+        static constexpr std::array<Setter, Size> setters = make_setters(std::make_index_sequence<Size>());
+        static constexpr std::array<Kind, Size>   kinds   = make_kinds(std::make_index_sequence<Size>());
+        static constexpr PerfectHash<Size>        index   { keys };
+
+        static_assert(index.valid(), "Srl error. Unable to build a perfect hash for SRL_FIELDS.");
+
+        template<size_t I> static void set(T& o, Node& node, const Value& value);
+
+        template<size_t... I>
+        static void resolve_all(T& o, Context& ctx, std::index_sequence<I...>);
+
+        template<size_t... I>
+        static void resolve_missing(T& o, Context& ctx, const std::array<bool, Size>& seen, std::index_sequence<I...>);
+
+        static void dispatch(T& o, Node& node, std::array<bool, Size>& seen);
+    };
+
+} }
+
+#define SRL_PP_CAT(a, b)  SRL_PP_CAT_(a, b)
+#define SRL_PP_CAT_(a, b) a ## b
+
+#define SRL_PP_NARG(...)  SRL_PP_NARG_(__VA_ARGS__, 64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49, 48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1)
+#define SRL_PP_NARG_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, _33, _34, _35, _36, _37, _38, _39, _40, _41, _42, _43, _44, _45, _46, _47, _48, _49, _50, _51, _52, _53, _54, _55, _56, _57, _58, _59, _60, _61, _62, _63, _64, n, ...) n
+
+#define SRL_PP_MAP(m, d, ...) SRL_PP_CAT(SRL_PP_MAP_, SRL_PP_NARG(__VA_ARGS__))(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_1(m, d, x)      m(d, x)
+#define SRL_PP_MAP_2(m, d, x, ...) m(d, x), SRL_PP_MAP_1(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_3(m, d, x, ...) m(d, x), SRL_PP_MAP_2(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_4(m, d, x, ...) m(d, x), SRL_PP_MAP_3(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_5(m, d, x, ...) m(d, x), SRL_PP_MAP_4(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_6(m, d, x, ...) m(d, x), SRL_PP_MAP_5(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_7(m, d, x, ...) m(d, x), SRL_PP_MAP_6(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_8(m, d, x, ...) m(d, x), SRL_PP_MAP_7(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_9(m, d, x, ...) m(d, x), SRL_PP_MAP_8(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_10(m, d, x, ...) m(d, x), SRL_PP_MAP_9(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_11(m, d, x, ...) m(d, x), SRL_PP_MAP_10(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_12(m, d, x, ...) m(d, x), SRL_PP_MAP_11(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_13(m, d, x, ...) m(d, x), SRL_PP_MAP_12(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_14(m, d, x, ...) m(d, x), SRL_PP_MAP_13(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_15(m, d, x, ...) m(d, x), SRL_PP_MAP_14(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_16(m, d, x, ...) m(d, x), SRL_PP_MAP_15(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_17(m, d, x, ...) m(d, x), SRL_PP_MAP_16(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_18(m, d, x, ...) m(d, x), SRL_PP_MAP_17(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_19(m, d, x, ...) m(d, x), SRL_PP_MAP_18(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_20(m, d, x, ...) m(d, x), SRL_PP_MAP_19(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_21(m, d, x, ...) m(d, x), SRL_PP_MAP_20(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_22(m, d, x, ...) m(d, x), SRL_PP_MAP_21(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_23(m, d, x, ...) m(d, x), SRL_PP_MAP_22(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_24(m, d, x, ...) m(d, x), SRL_PP_MAP_23(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_25(m, d, x, ...) m(d, x), SRL_PP_MAP_24(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_26(m, d, x, ...) m(d, x), SRL_PP_MAP_25(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_27(m, d, x, ...) m(d, x), SRL_PP_MAP_26(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_28(m, d, x, ...) m(d, x), SRL_PP_MAP_27(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_29(m, d, x, ...) m(d, x), SRL_PP_MAP_28(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_30(m, d, x, ...) m(d, x), SRL_PP_MAP_29(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_31(m, d, x, ...) m(d, x), SRL_PP_MAP_30(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_32(m, d, x, ...) m(d, x), SRL_PP_MAP_31(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_33(m, d, x, ...) m(d, x), SRL_PP_MAP_32(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_34(m, d, x, ...) m(d, x), SRL_PP_MAP_33(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_35(m, d, x, ...) m(d, x), SRL_PP_MAP_34(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_36(m, d, x, ...) m(d, x), SRL_PP_MAP_35(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_37(m, d, x, ...) m(d, x), SRL_PP_MAP_36(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_38(m, d, x, ...) m(d, x), SRL_PP_MAP_37(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_39(m, d, x, ...) m(d, x), SRL_PP_MAP_38(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_40(m, d, x, ...) m(d, x), SRL_PP_MAP_39(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_41(m, d, x, ...) m(d, x), SRL_PP_MAP_40(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_42(m, d, x, ...) m(d, x), SRL_PP_MAP_41(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_43(m, d, x, ...) m(d, x), SRL_PP_MAP_42(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_44(m, d, x, ...) m(d, x), SRL_PP_MAP_43(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_45(m, d, x, ...) m(d, x), SRL_PP_MAP_44(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_46(m, d, x, ...) m(d, x), SRL_PP_MAP_45(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_47(m, d, x, ...) m(d, x), SRL_PP_MAP_46(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_48(m, d, x, ...) m(d, x), SRL_PP_MAP_47(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_49(m, d, x, ...) m(d, x), SRL_PP_MAP_48(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_50(m, d, x, ...) m(d, x), SRL_PP_MAP_49(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_51(m, d, x, ...) m(d, x), SRL_PP_MAP_50(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_52(m, d, x, ...) m(d, x), SRL_PP_MAP_51(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_53(m, d, x, ...) m(d, x), SRL_PP_MAP_52(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_54(m, d, x, ...) m(d, x), SRL_PP_MAP_53(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_55(m, d, x, ...) m(d, x), SRL_PP_MAP_54(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_56(m, d, x, ...) m(d, x), SRL_PP_MAP_55(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_57(m, d, x, ...) m(d, x), SRL_PP_MAP_56(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_58(m, d, x, ...) m(d, x), SRL_PP_MAP_57(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_59(m, d, x, ...) m(d, x), SRL_PP_MAP_58(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_60(m, d, x, ...) m(d, x), SRL_PP_MAP_59(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_61(m, d, x, ...) m(d, x), SRL_PP_MAP_60(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_62(m, d, x, ...) m(d, x), SRL_PP_MAP_61(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_63(m, d, x, ...) m(d, x), SRL_PP_MAP_62(m, d, __VA_ARGS__)
+#define SRL_PP_MAP_64(m, d, x, ...) m(d, x), SRL_PP_MAP_63(m, d, __VA_ARGS__)
+
+#define SRL_FIELDS_ENTRY(T, f) Srl::Lib::make_field(Srl::Key(#f), &T::f)
+
+/* Declares the serialized members of a class and generates its srl_resolve
+ * method. Use inside the class body:
+ *
+ *     struct Point {
+ *         int x, y, z;
+ *         SRL_FIELDS(Point, x, y, z)
+ *     };
+ */
+#define SRL_FIELDS(T, ...)                                                         \
+    static constexpr auto srl_fields()                                             \
+    {                                                                              \
+        return std::make_tuple(SRL_PP_MAP(SRL_FIELDS_ENTRY, T, __VA_ARGS__));      \
+    }                                                                              \
+    void srl_resolve(Srl::Context& ctx)                                            \
+    {                                                                              \
+        Srl::Lib::FieldTable<T>::Resolve(*this, ctx);                              \
+    }
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef SRL_FIELDS_HPP
+#define SRL_FIELDS_HPP
+
+#include "Fields.h"
+#include "Node.h"
+#include "Context.h"
+#include "String.h"
+#include "Value.h"
+#include "TpTools.h"
+
+namespace Srl { namespace Lib {
+
+    template<size_t N>
+    constexpr PerfectHash<N>::PerfectHash(const std::array<Key, N>& keys_)
+        : keys(keys_), slots { }, seed(0)
+    {
+        for(uint64_t s = 1; s < (1 << 16) && this->seed == 0; s++) {
+
+            for(auto& slt : this->slots) {
+                slt = 0;
+            }
+
+            bool collision = false;
+
+            for(auto i = 0U; i < N && !collision; i++) {
+                auto& slt = this->slots[this->slot(keys_[i].hash(), s)];
+                collision = slt != 0;
+                slt = i + 1;
+            }
+
+            if(!collision) {
+                this->seed = s;
+            }
+        }
+    }
+
+    template<size_t N>
+    size_t PerfectHash<N>::find(const uint8_t* name, size_t nbytes, uint64_t hash) const
+    {
+        auto idx = this->slots[this->slot(hash, this->seed)];
+
+        if(idx == 0) {
+            return N;
+        }
+
+        auto& key = this->keys[idx - 1];
+
+        return key.hash() == hash && key.size() == nbytes && memcmp(key.data(), name, nbytes) == 0
+            ? idx - 1 : N;
+    }
+
+    template<class T> template<class M>
+    constexpr typename FieldTable<T>::Kind FieldTable<T>::kind_of()
+    {
+        if constexpr(std::is_same<M, Union>::value) {
+            return Kind::Other;
+
+        } else {
+            return TpTools::is_scope(Switch<M>::type) ? Kind::Scope : Kind::Value;
+        }
+    }
+
+    template<class T>
+    void FieldTable<T>::Resolve(T& o, Context& ctx)
+    {
+        auto indices = std::make_index_sequence<Size>();
+
+        if(ctx.mode() == Mode::Insert || ctx.node().parsed) {
+            resolve_all(o, ctx, indices);
+            return;
+        }
+
+        std::array<bool, Size> seen { };
+        dispatch(o, ctx.node(), seen);
+        /* anything not dispatched is either stored in the node by now or missing */
+        resolve_missing(o, ctx, seen, indices);
+    }
+
+    template<class T> template<size_t... I>
+    void FieldTable<T>::resolve_all(T& o, Context& ctx, std::index_sequence<I...>)
+    {
+        (ctx(std::get<I>(fields).key, o.*(std::get<I>(fields).member)), ...);
+    }
+
+    template<class T> template<size_t... I>
+    void FieldTable<T>::resolve_missing(T& o, Context& ctx, const std::array<bool, Size>& seen,
+                                        std::index_sequence<I...>)
+    {
+        ((seen[I] ? ctx : ctx(std::get<I>(fields).key, o.*(std::get<I>(fields).member))), ...);
+    }
+
+    template<class T> template<size_t I>
+    void FieldTable<T>::set(T& o, Node& node, const Value& value)
+    {
+        auto& field = o.*(std::get<I>(fields).member);
+        typedef typename std::remove_reference<decltype(field)>::type M;
+
+        Aux::adopt_resource(field, node.env->resource);
+
+        if constexpr(std::is_same<M, Union>::value) {
+            /* never dispatched */
+
+        } else if constexpr(TpTools::is_scope(Switch<M>::type)) {
+            auto itm = node.child_node(value);
+            Switch<M>::Paste(field, itm, keys[I]);
+            itm.consume_scope();
+
+        } else {
+            Switch<M>::Paste(field, value, keys[I]);
+        }
+    }
+
+    template<class T>
+    void FieldTable<T>::dispatch(T& o, Node& node, std::array<bool, Size>& seen)
+    {
+        auto& env  = *node.env;
+        size_t next = 0;
+
+        while(!node.parsed) {
+
+            MemBlock seg_name; Value val;
+            std::tie(seg_name, val) = env.read();
+
+            auto tp = val.type();
+
+            if(tp == Type::Scope_End) {
+                node.parsed = true;
+                break;
+            }
+
+            /* fields in declaration order match without hashing */
+            auto idx = next < Size && keys[next].size() == seg_name.size &&
+                       memcmp(keys[next].data(), seg_name.ptr, seg_name.size) == 0
+                ? next
+                : index.find(seg_name.ptr, seg_name.size, Aux::hash_fnc(seg_name.ptr, seg_name.size));
+
+            bool is_scope = TpTools::is_scope(tp);
+
+            if(idx < Size && !seen[idx] && kinds[idx] == (is_scope ? Kind::Scope : Kind::Value)) {
+                setters[idx](o, node, val);
+                seen[idx] = true;
+                next = idx + 1;
+                continue;
+            }
+
+            if(is_scope) {
+                node.store_scope(val, seg_name);
+
+            } else {
+                env.store_value(node, val, seg_name);
+            }
+        }
+    }
+
+} }
+
+#endif
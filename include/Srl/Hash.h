@@ -5,7 +5,9 @@
 #include "Aux.h"
 #include "Srl/Exception.h"
 
+#include <array>
 #include <cmath>
+#include <cstring>
 #include <deque>
 #include <optional>
 #include <type_traits>
@@ -16,14 +18,140 @@ namespace Srl { namespace Lib {
 
     namespace Aux {
 
+        /* wyhash, reads 8 or 16 bytes per step, the seed decides which names share a bucket */
+        namespace Wy {
+
+            constexpr uint64_t P0 = 0xA0761D6478BD642F;
+            constexpr uint64_t P1 = 0xE7037ED1A0B428DB;
+            constexpr uint64_t P2 = 0x8EBC6AF09C88C6E3;
+            constexpr uint64_t P3 = 0x589965CC75374CC3;
+
+            /* 128 bit product of a and b, low half in a, high half in b */
+            constexpr void mum(uint64_t& a, uint64_t& b)
+            {
+#ifdef __SIZEOF_INT128__
+                __extension__ typedef unsigned __int128 uint128;
+                uint128 r = (uint128)a * b;
+                a = (uint64_t)r;
+                b = (uint64_t)(r >> 64);
+#else
+                uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+                uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+                uint64_t t  = rl + (rm0 << 32);
+                uint64_t c  = t < rl;
+                uint64_t lo = t + (rm1 << 32);
+                c += lo < t;
+                a = lo;
+                b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+            }
+
+            constexpr uint64_t mix(uint64_t a, uint64_t b)
+            {
+                mum(a, b);
+                return a ^ b;
+            }
+
+            /* little endian reads, bytewise for literals */
+            template<class C> constexpr uint64_t read4(const C* p)
+            {
+                return (uint64_t)(uint8_t)p[0]       | (uint64_t)(uint8_t)p[1] << 8
+                     | (uint64_t)(uint8_t)p[2] << 16 | (uint64_t)(uint8_t)p[3] << 24;
+            }
+
+            template<class C> constexpr uint64_t read8(const C* p)
+            {
+                return read4(p) | read4(p + 4) << 32;
+            }
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            /* single loads for bytes at runtime */
+            inline uint64_t read4(const uint8_t* p)
+            {
+                uint32_t v = 0;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+
+            inline uint64_t read8(const uint8_t* p)
+            {
+                uint64_t v = 0;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+#endif
+
+            template<class C> constexpr uint64_t read3(const C* p, size_t n)
+            {
+                return (uint64_t)(uint8_t)p[0] << 16 | (uint64_t)(uint8_t)p[n >> 1] << 8 | (uint64_t)(uint8_t)p[n - 1];
+            }
+
+            template<class C> constexpr uint64_t hash(const C* p, size_t n, uint64_t seed)
+            {
+                /* goes into the input side of every multiply, without it input words cancelling
+                 * out a constant zero the product for any seed */
+                auto key = mix(seed ^ P2, P3);
+                seed ^= mix(seed ^ P0, P1);
+                uint64_t a = 0, b = 0;
+
+                if(n <= 16) {
+                    if(n >= 4) {
+                        auto off = (n >> 3) << 2;
+                        a = read4(p) << 32 | read4(p + off);
+                        b = read4(p + n - 4) << 32 | read4(p + n - 4 - off);
+
+                    } else if(n > 0) {
+                        a = read3(p, n);
+                    }
+
+                } else {
+                    auto i = n;
+                    if(i > 48) {
+                        auto seed1 = seed, seed2 = seed;
+                        do {
+                            seed  = mix(read8(p) ^ P1 ^ key, read8(p + 8) ^ seed);
+                            seed1 = mix(read8(p + 16) ^ P2 ^ key, read8(p + 24) ^ seed1);
+                            seed2 = mix(read8(p + 32) ^ P3 ^ key, read8(p + 40) ^ seed2);
+                            p += 48; i -= 48;
+                        } while(i > 48);
+                        seed ^= seed1 ^ seed2;
+                    }
+                    while(i > 16) {
+                        seed = mix(read8(p) ^ P1 ^ key, read8(p + 8) ^ seed);
+                        p += 16; i -= 16;
+                    }
+                    a = read8(p + i - 16);
+                    b = read8(p + i - 8);
+                }
+
+                a ^= P1 ^ key;
+                b ^= seed;
+                mum(a, b);
+
+                return mix(a ^ P0 ^ n, b ^ P1);
+            }
+        }
+
+        /* unseeded, stable across processes, for hashes known at compile time and stored in links */
         uint64_t hash_fnc(const uint8_t* bytes, size_t nbytes);
 
+        /* compile-time variant of hash_fnc, yields the same hash for the same bytes */
+        constexpr uint64_t hash_literal(const char* chars, size_t nchars)
+        {
+            return Wy::hash(chars, nchars, 0);
+        }
+
+        /* random per process, picked on first use */
+        uint64_t hash_seed();
+
+        /* seeded with hash_seed, for tables filled with names from untrusted input */
+        uint64_t hash_seeded(const uint8_t* bytes, size_t nbytes);
     }
 
     template<class T, class = void> struct HashSrl;
 
     template<> struct HashSrl<std::string> {
-        uint64_t operator() (const std::string& s) const { return Aux::hash_fnc((const uint8_t*)s.data(), s.size()); }
+        uint64_t operator() (const std::string& s) const { return Aux::hash_seeded((const uint8_t*)s.data(), s.size()); }
     };
 
 
@@ -38,6 +166,17 @@ namespace Srl { namespace Lib {
     };
 #endif
 
+    struct TableStats {
+        size_t      entries       = 0;
+        size_t      buckets       = 0;
+        /* entries per bucket */
+        double      load_factor   = 0.0;
+        /* most steps looking up a stored key takes, entries in a bucket or groups probed */
+        size_t      longest_chain = 0;
+        /* entries and bucket arrays */
+        Heap::Stats heap;
+    };
+
     template <class Key, class Val, class HashFnc = HashSrl<Key>>
     class HTable {
 
@@ -65,6 +204,14 @@ namespace Srl { namespace Lib {
         template<class KV, class... Args>
         std::pair<bool, Val*> upsert (KV&& key, Args&&... args);
 
+        /* with the hash of the key computed upfront by hash(), so a lookup followed by an insert hashes once */
+        uint64_t hash (const Key& key) const { return this->hash_fnc(key); }
+
+        Val* get (const Key& key, uint64_t hash);
+
+        template<class KV, class... Args>
+        std::pair<bool, Val*> insert_hashed (uint64_t hash, KV&& key, Args&&... args);
+
         void foreach(const std::function<void(const Key&, Val&)>& fnc) const;
 
         void foreach_break(const std::function<bool(const Key&, Val&)>& fnc) const;
@@ -77,8 +224,18 @@ namespace Srl { namespace Lib {
 
         size_t num_entries() const { return this->elements; }
 
+        /* walks all buckets */
+        TableStats stats() const;
+
         void clear();
 
+        /* sizes the table for n_entries, an allocated table is rehashed at once */
+        void reserve(size_t n_entries);
+
+        /* Growing keeps the old buckets, each following insert and lookup moves a few of them into
+         * the new table instead of rehashing all entries at once. Iterating finishes the move. */
+        void incremental_rehash(bool enable = true) { this->incremental = enable; }
+
         struct Iterator;
 
         Iterator begin() noexcept
@@ -104,6 +261,9 @@ namespace Srl { namespace Lib {
             Val      val;
         };
 
+        /* buckets moved per insert or lookup while growing incrementally */
+        static const size_t Migrate_Buckets = 8;
+
         double load_factor;
         size_t cap;
 
@@ -113,15 +273,31 @@ namespace Srl { namespace Lib {
         Entry** table = nullptr;
         std::vector<Entry*> mem_cache;
 
+        bool    incremental = false;
+        /* buckets before migrated are moved already */
+        Entry** old_table   = nullptr;
+        size_t  old_cap     = 0;
+        size_t  migrated    = 0;
+
         HashFnc hash_fnc;
         Heap    heap;
 
         void     redistribute();
-        uint64_t get_bucket(uint64_t hash);
+        void     grow(size_t new_cap, size_t n_buckets);
+        void     migrate(size_t n_buckets);
+        void     relink(Entry* entry);
+        uint64_t get_bucket(uint64_t hash, size_t dim) const;
         void     set_capacity(size_t new_cap);
 
         Entry** alloc_table(size_t sz);
 
+        /* the current table and the one still being moved from, with their capacities */
+        std::array<std::pair<Entry**, size_t>, 2> tables() const
+        {
+            return { { { this->table, this->cap }, { this->old_table, this->old_cap } } };
+        }
+
+        Entry* find   (const Key& k, uint64_t hash) const;
         Entry* get_rm (const Key& k, uint64_t hash);
 
         template<class KV, class... Args>
@@ -146,6 +322,106 @@ namespace Srl { namespace Lib {
         destroy_all();
     };
 
+    /* Open addressing table with the same interface as HTable. Entries are stored inline next to an array
+     * of control bytes, one per slot, holding 7 bits of the entry's hash or marking the slot as empty or
+     * deleted. Lookups compare the control bytes of a group of slots at once, with SSE2 where available,
+     * and only look at entries whose hash bits match. Capacity is a power of two, groups are probed
+     * quadratically. Pointers to values are invalidated by inserting. */
+    template <class Key, class Val, class HashFnc = HashSrl<Key>>
+    class FlatTable {
+
+    public:
+        FlatTable(size_t capacity = 16) : initial_cap(capacity) { }
+
+        ~FlatTable() { destroy_all(); }
+
+        FlatTable(const FlatTable& m)             = delete;
+        FlatTable& operator= (const FlatTable& m) = delete;
+
+        FlatTable(FlatTable&& m) { *this = std::forward<FlatTable>(m); }
+
+        FlatTable& operator= (FlatTable&& m);
+
+        Val* get (const Key& key);
+        /* fst -> exists? snd -> entry */
+        template<class KV, class... Args>
+        std::pair<bool, Val*> insert (KV&& key, Args&&... args);
+
+        /* fst -> updated? snd -> entry */
+        template<class KV, class... Args>
+        std::pair<bool, Val*> upsert (KV&& key, Args&&... args);
+
+        void foreach(const std::function<void(const Key&, Val&)>& fnc) const;
+
+        void foreach_break(const std::function<bool(const Key&, Val&)>& fnc) const;
+
+        void remove_if(const std::function<bool(const Key&, Val&)>& fnc);
+
+        void remove(const Key& key);
+
+        std::optional<Val> extract(const Key& key);
+
+        size_t num_entries() const { return this->elements; }
+
+        /* keeps the capacity */
+        void clear();
+
+        /* sizes the table for n_entries */
+        void reserve(size_t n_entries);
+
+        /* probes all stored keys */
+        TableStats stats() const;
+
+        struct Iterator;
+
+        Iterator begin() noexcept
+        {
+            return Iterator(this);
+        }
+
+        Iterator end() noexcept
+        {
+            return Iterator();
+        }
+
+    private:
+        struct Slot {
+
+            template<class KV, class... Args> Slot (KV&& key_, Args&&... args)
+                : key(std::forward<KV>(key_)), val(std::forward<Args>(args)...) { }
+
+            Key key;
+            Val val;
+        };
+
+        static const size_t Group_Width = 16;
+        static const int8_t Empty       = -128;
+        static const int8_t Deleted     = -2;
+
+        size_t initial_cap;
+        size_t cap         = 0;
+        size_t elements    = 0;
+        /* inserts into empty slots until the table is rehashed, keeps the load at 7 / 8 at most */
+        size_t growth_left = 0;
+
+        /* cap + Group_Width bytes, the first group is mirrored behind the last slot */
+        int8_t* ctrl  = nullptr;
+        Slot*   slots = nullptr;
+
+        HashFnc hash_fnc;
+        Heap    heap;
+
+        uint64_t hash      (const Key& key) const;
+        size_t   find      (const Key& key, uint64_t hash) const;
+        size_t   find_slot (uint64_t hash) const;
+        void     set_ctrl  (size_t index, int8_t val);
+        void     erase     (size_t index);
+        void     rehash    (size_t new_cap);
+        void     destroy_all();
+
+        template<class KV, class... Args>
+        std::pair<bool, Val*> insert_hash (bool update_on_dup, KV&& key, Args&&... args);
+    };
 
 } }
 
@@ -3,9 +3,15 @@
 
 #include "Hash.h"
 #include <algorithm>
+#include <cstring>
 #include <optional>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64)
+    #define SRL_SSE2_GROUPS
+    #include <emmintrin.h>
+#endif
+
 namespace Srl { namespace Lib {
 
     template<class K, class V, class H>
@@ -24,18 +30,28 @@ namespace Srl { namespace Lib {
 
         this->table     = m.table;
         this->mem_cache = std::move(m.mem_cache);
+        this->heap      = std::move(m.heap);
+
+        this->incremental = m.incremental;
+        this->old_table   = m.old_table;
+        this->old_cap     = m.old_cap;
+        this->migrated    = m.migrated;
+
+        m.table     = nullptr;
+        m.old_table = nullptr;
+        m.old_cap   = 0;
 
         return *this;
     }
 
     template<class K, class V, class H>
-    uint64_t HTable<K, V, H>::get_bucket(uint64_t hash)
+    uint64_t HTable<K, V, H>::get_bucket(uint64_t hash, size_t dim) const
     {
         /* mix in the upper half bits of the hash unless table capacity is bigger 2 ^ (bits in word / 2) - 1 */
         const auto shift = sizeof(uint64_t) * 4;
         const auto lim   = ~(uint64_t)0 >> shift;
 
-        return (this->cap <= lim ? hash ^ hash >> shift : hash) % this->cap;
+        return (dim <= lim ? hash ^ hash >> shift : hash) % dim;
     }
 
     template<class K, class V, class H>
@@ -56,38 +72,87 @@ namespace Srl { namespace Lib {
             return;
         }
 
-        auto old_dim = this->cap;
-        this->set_capacity(this->cap * 2);
+        this->grow(this->cap * 2, this->incremental ? Migrate_Buckets : this->cap);
+    }
 
-        auto* ntable = alloc_table(this->cap);
+    /* moves the first n_buckets of the current table into a new one, the rest follows with migrate */
+    template<class K, class V, class H>
+    void HTable<K, V, H>::grow(size_t new_cap, size_t n_buckets)
+    {
+        SRL_COUNT(table_rehashes, 1);
 
-        for(auto i = 0U; i < old_dim; i++) {
-            auto* entry = table[i];
-            while(entry) {
-                auto bucket = get_bucket(entry->hash);
-                auto* slot = ntable[bucket];
+        /* a previous growth step still moving is finished first */
+        this->migrate(this->old_cap);
 
-                if(!slot) {
-                    ntable[bucket] = entry;
+        this->old_table = this->table;
+        this->old_cap   = this->cap;
+        this->migrated  = 0;
 
-                } else while(true) {
-                    if(!slot->next) {
-                        slot->next = entry;
-                        break;
-                    }
-                    slot = slot->next;
-                }
+        this->set_capacity(new_cap);
+        this->table = this->alloc_table(this->cap);
 
-                auto* tmp = entry;
-                entry = entry->next;
-                tmp->next = nullptr;
+        this->migrate(n_buckets);
+    }
+
+    template<class K, class V, class H>
+    void HTable<K, V, H>::migrate(size_t n_buckets)
+    {
+        if(!this->old_table) {
+            return;
+        }
+
+        auto end = this->old_cap - this->migrated > n_buckets ? this->migrated + n_buckets : this->old_cap;
+
+        for(; this->migrated < end; this->migrated++) {
+            auto* entry = this->old_table[this->migrated];
+
+            while(entry) {
+                auto* next = entry->next;
+                this->relink(entry);
+                entry = next;
             }
+
+            this->old_table[this->migrated] = nullptr;
+        }
+
+        if(this->migrated >= this->old_cap) {
+            this->heap.put_mem((uint8_t*)this->old_table, this->old_cap * sizeof(nullptr));
+            this->old_table = nullptr;
+            this->old_cap   = 0;
+        }
+    }
+
+    /* appended to its bucket, entries keep their order */
+    template<class K, class V, class H>
+    void HTable<K, V, H>::relink(Entry* entry)
+    {
+        entry->next = nullptr;
+
+        auto** slot = &this->table[get_bucket(entry->hash, this->cap)];
+        while(*slot) {
+            slot = &(*slot)->next;
         }
 
-        this->heap.put_mem((uint8_t*)this->table, old_dim * sizeof(nullptr));
-        this->table = ntable;
+        *slot = entry;
     }
 
+    template<class K, class V, class H>
+    void HTable<K, V, H>::reserve(size_t n_entries)
+    {
+        auto dim = (size_t)std::ceil(n_entries / this->load_factor) + 1;
+
+        if(dim <= this->cap) {
+            return;
+        }
+
+        if(this->limit == 0) {
+            /* allocated with the first insert */
+            this->cap = dim;
+            return;
+        }
+
+        this->grow(dim, this->cap);
+    }
 
     template<class K, class V, class H>
     V* HTable<K, V, H>::get(const K& key)
@@ -96,20 +161,48 @@ namespace Srl { namespace Lib {
             return nullptr;
         }
 
-        auto hash    = hash_fnc(key);
-        auto bucket  = get_bucket(hash);
-        Entry* entry = table[bucket];
+        return this->get(key, hash_fnc(key));
+    }
+
+    template<class K, class V, class H>
+    V* HTable<K, V, H>::get(const K& key, uint64_t hash)
+    {
+        if(elements < 1) {
+            return nullptr;
+        }
+
+        this->migrate(Migrate_Buckets);
+
+        auto* entry = this->find(key, hash);
+
+        return entry ? &entry->val : nullptr;
+    }
+
+    /* entries not moved yet are in the old table, moved buckets are empty there */
+    template<class K, class V, class H>
+    typename HTable<K, V, H>::Entry* HTable<K, V, H>::find(const K& key, uint64_t hash) const
+    {
+        SRL_COUNT(table_lookups, 1);
+
+        const auto search = [&key, hash](Entry* entry) -> Entry* {
+            while(entry) {
+                SRL_COUNT(table_probes, 1);
 
-        while(entry) {
+                if(entry->hash == hash && entry->key == key) {
+                    return entry;
+                }
 
-            if(entry->hash == hash && entry->key == key) {
-                return &entry->val;
+                entry = entry->next;
             }
 
-            entry = entry->next;
+            return nullptr;
+        };
+
+        if(auto* entry = search(this->table[get_bucket(hash, this->cap)])) {
+            return entry;
         }
 
-        return nullptr;
+        return this->old_table ? search(this->old_table[get_bucket(hash, this->old_cap)]) : nullptr;
     }
 
     template<class K, class V, class H>
@@ -119,28 +212,28 @@ namespace Srl { namespace Lib {
             return nullptr;
         }
 
-        auto bucket  = get_bucket(hash);
-        Entry* entry = table[bucket];
-        Entry* prev  = nullptr;
-
-        while(entry) {
+        this->migrate(Migrate_Buckets);
 
-            if(entry->hash == hash && entry->key == key) {
-                if(prev) {
-                    prev->next = entry->next;
+        const auto unlink = [&key, hash](Entry** slot) -> Entry* {
+            while(*slot) {
+                auto* entry = *slot;
 
-                } else if(table[bucket] == entry) {
-                    table[bucket] = entry->next;
+                if(entry->hash == hash && entry->key == key) {
+                    *slot = entry->next;
+                    return entry;
                 }
 
-                return entry;
+                slot = &entry->next;
             }
 
-            prev  = entry;
-            entry = entry->next;
+            return nullptr;
+        };
+
+        if(auto* entry = unlink(&this->table[get_bucket(hash, this->cap)])) {
+            return entry;
         }
 
-        return nullptr;
+        return this->old_table ? unlink(&this->old_table[get_bucket(hash, this->old_cap)]) : nullptr;
     }
 
     template<class K, class V, class H> template<class KV, class... Args>
@@ -150,6 +243,12 @@ namespace Srl { namespace Lib {
         return insert_hash(hash, false, std::forward<KV>(key), std::forward<Args>(args)...);
     }
 
+    template<class K, class V, class H> template<class KV, class... Args>
+    std::pair<bool, V*> HTable<K, V, H>::insert_hashed(uint64_t hash, KV&& key, Args&&... args)
+    {
+        return insert_hash(hash, false, std::forward<KV>(key), std::forward<Args>(args)...);
+    }
+
     template<class K, class V, class H> template<class KV, class... Args>
     std::pair<bool, V*> HTable<K, V, H>::upsert(KV&& key, Args&&... args)
     {
@@ -166,25 +265,43 @@ namespace Srl { namespace Lib {
             this->redistribute();
         }
 
-        auto bucket  = get_bucket(hash);
+        this->migrate(Migrate_Buckets);
+
+        SRL_COUNT(table_lookups, 1);
+
+        /* converted once, keys of other types are compared as K */
+        const K& cmp_key = key;
+
+        auto bucket  = get_bucket(hash, this->cap);
         Entry* entry = table[bucket];
         Entry* prev  = nullptr;
 
-        while(entry) {
+        while(entry && !(entry->hash == hash && entry->key == cmp_key)) {
+            SRL_COUNT(table_probes, 1);
 
-            if(entry->hash == hash && entry->key == key) {
+            prev  = entry;
+            entry = entry->next;
+        }
 
-                if(update_on_dup) {
+        /* not moved yet */
+        if(!entry && this->old_table) {
+            entry = this->old_table[get_bucket(hash, this->old_cap)];
 
-                    this->destroy_item(entry->val);
-                    new (&entry->val) V(std::forward<Args>(args)...);
-                }
+            while(entry && !(entry->hash == hash && entry->key == cmp_key)) {
+                SRL_COUNT(table_probes, 1);
+                entry = entry->next;
+            }
+        }
+
+        if(entry) {
 
-                return { true, &entry->val };
+            if(update_on_dup) {
+
+                this->destroy_item(entry->val);
+                new (&entry->val) V(std::forward<Args>(args)...);
             }
 
-            prev  = entry;
-            entry = entry->next;
+            return { true, &entry->val };
         }
 
         Entry* mem = nullptr;
@@ -222,8 +339,38 @@ namespace Srl { namespace Lib {
         this->destroy_all<K, V>();
         this->heap.clear();
         this->mem_cache.clear();
-        this->elements = 0;
-        this->limit    = 0;
+        this->elements  = 0;
+        this->limit     = 0;
+        this->old_table = nullptr;
+        this->old_cap   = 0;
+    }
+
+    template<class K, class V, class H>
+    TableStats HTable<K, V, H>::stats() const
+    {
+        TableStats stats;
+        stats.entries = this->elements;
+        stats.heap    = this->heap.stats();
+
+        /* the table is allocated with the first insert after clearing */
+        if(this->limit == 0) {
+            return stats;
+        }
+
+        stats.buckets     = this->cap;
+        stats.load_factor = (double)this->elements / this->cap;
+
+        for(auto& tbl : this->tables()) {
+            for(auto i = 0U; i < tbl.second; i++) {
+                size_t chain = 0;
+                for(auto* entry = tbl.first[i]; entry; entry = entry->next) {
+                    chain++;
+                }
+                stats.longest_chain = std::max(stats.longest_chain, chain);
+            }
+        }
+
+        return stats;
     }
 
     template<class K, class V, class H>
@@ -244,24 +391,26 @@ namespace Srl { namespace Lib {
 
         auto n = 0U;
 
-        for(auto i = 0U; i < this->cap; i++) {
+        for(auto& tbl : this->tables()) {
+            for(auto i = 0U; i < tbl.second; i++) {
 
-            auto* entry = table[i];
+                auto* entry = tbl.first[i];
 
-            while(entry) {
+                while(entry) {
 
-                auto abort = fnc(entry->key, entry->val);
+                    auto abort = fnc(entry->key, entry->val);
 
-                if(abort) {
-                    return;
-                }
+                    if(abort) {
+                        return;
+                    }
 
-                entry = entry->next;
-                n++;
-            }
+                    entry = entry->next;
+                    n++;
+                }
 
-            if(n >= this->elements) {
-                break;
+                if(n >= this->elements) {
+                    return;
+                }
             }
         }
     }
@@ -286,40 +435,38 @@ namespace Srl { namespace Lib {
         auto n = 0U;
         auto n_deleted = 0U;
 
-        for(auto i = 0U; i < this->cap; i++) {
-
-            Entry* prev = nullptr;
-            auto* entry = table[i];
+        for(auto& tbl : this->tables()) {
+            for(auto i = 0U; i < tbl.second && n < this->elements; i++) {
 
-            while(entry) {
+                Entry* prev = nullptr;
+                auto* entry = tbl.first[i];
 
-                n++;
-                auto do_rm = fnc(entry->key, entry->val);
+                while(entry) {
 
-                if(do_rm) {
+                    n++;
+                    auto do_rm = fnc(entry->key, entry->val);
 
-                    n_deleted++;
+                    if(do_rm) {
 
-                    if(prev) {
-                        prev->next = entry->next;
-                    } else {
-                        table[i] = entry->next;
-                    }
+                        n_deleted++;
 
-                    destroy_item<K>(entry->key);
-                    destroy_item<V>(entry->val);
+                        if(prev) {
+                            prev->next = entry->next;
+                        } else {
+                            tbl.first[i] = entry->next;
+                        }
 
-                    this->mem_cache.push_back(entry);
+                        destroy_item<K>(entry->key);
+                        destroy_item<V>(entry->val);
 
-                } else {
-                    prev = entry;
-                }
+                        this->mem_cache.push_back(entry);
 
-                entry = entry->next;
-            }
+                    } else {
+                        prev = entry;
+                    }
 
-            if(n >= this->elements) {
-                break;
+                    entry = entry->next;
+                }
             }
         }
 
@@ -388,6 +535,8 @@ namespace Srl { namespace Lib {
 
         Iterator(HTable<K, V, H>* htbl_) noexcept : htbl(htbl_)
         {
+            /* buckets are only walked in the current table */
+            htbl->migrate(htbl->old_cap);
             advance();
         }
 
@@ -447,6 +596,503 @@ namespace Srl { namespace Lib {
         }
     };
 
+    namespace Aux {
+
+        /* control bytes of 16 consecutive slots of a FlatTable, matches are bit masks with bit i set for slot i */
+        class CtrlGroup {
+
+        public:
+            explicit CtrlGroup(const int8_t* pos)
+            {
+#ifdef SRL_SSE2_GROUPS
+                this->ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+#else
+                memcpy(this->ctrl, pos, sizeof(this->ctrl));
+#endif
+            }
+
+            uint32_t match (int8_t byte) const
+            {
+#ifdef SRL_SSE2_GROUPS
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(byte), this->ctrl));
+#else
+                uint32_t mask = 0;
+                for(auto i = 0U; i < sizeof(this->ctrl); i++) {
+                    mask |= (uint32_t)(this->ctrl[i] == byte) << i;
+                }
+                return mask;
+#endif
+            }
+
+            /* empty and deleted slots are the only negative control bytes below -1 */
+            uint32_t match_free () const
+            {
+#ifdef SRL_SSE2_GROUPS
+                return _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), this->ctrl));
+#else
+                uint32_t mask = 0;
+                for(auto i = 0U; i < sizeof(this->ctrl); i++) {
+                    mask |= (uint32_t)(this->ctrl[i] < -1) << i;
+                }
+                return mask;
+#endif
+            }
+
+        private:
+#ifdef SRL_SSE2_GROUPS
+            __m128i ctrl;
+#else
+            int8_t  ctrl[16];
+#endif
+        };
+
+        inline size_t trailing_zeros (uint32_t mask)
+        {
+            assert(mask != 0);
+#if defined(__GNUC__)
+            return __builtin_ctz(mask);
+#else
+            size_t n = 0;
+            while(!(mask & 1)) {
+                mask >>= 1;
+                n++;
+            }
+            return n;
+#endif
+        }
+
+        /* of a 16 bit mask */
+        inline size_t leading_zeros (uint32_t mask)
+        {
+            size_t n = 0;
+            for(uint32_t bit = 1 << 15; bit && !(mask & bit); bit >>= 1) {
+                n++;
+            }
+            return n;
+        }
+    }
+
+    template<class K, class V, class H>
+    FlatTable<K, V, H>& FlatTable<K, V, H>::operator= (FlatTable<K, V, H>&& m)
+    {
+        this->destroy_all();
+
+        this->initial_cap = m.initial_cap;
+        this->cap         = m.cap;
+        this->elements    = m.elements;
+        this->growth_left = m.growth_left;
+        this->ctrl        = m.ctrl;
+        this->slots       = m.slots;
+        this->heap        = std::move(m.heap);
+
+        m.cap         = 0;
+        m.elements    = 0;
+        m.growth_left = 0;
+        m.ctrl        = nullptr;
+        m.slots       = nullptr;
+
+        return *this;
+    }
+
+    /* The hash functions of integers and addresses are the identity. Mixed, the upper 7 bits go
+     * into the control bytes and the lower ones pick the first group. */
+    template<class K, class V, class H>
+    uint64_t FlatTable<K, V, H>::hash(const K& key) const
+    {
+        uint64_t hash = this->hash_fnc(key);
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCD;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+    template<class K, class V, class H>
+    size_t FlatTable<K, V, H>::find(const K& key, uint64_t hash) const
+    {
+        if(this->elements < 1) {
+            return this->cap;
+        }
+
+        SRL_COUNT(table_lookups, 1);
+
+        const auto mask = this->cap - 1;
+        const auto h2   = (int8_t)(hash >> 57);
+
+        auto pos  = hash & mask;
+        auto step = 0U;
+
+        while(true) {
+            Aux::CtrlGroup group (this->ctrl + pos);
+
+            for(auto match = group.match(h2); match; match &= match - 1) {
+                SRL_COUNT(table_probes, 1);
+
+                auto index = (pos + Aux::trailing_zeros(match)) & mask;
+                if(this->slots[index].key == key) {
+                    return index;
+                }
+            }
+
+            if(group.match(Empty)) {
+                return this->cap;
+            }
+
+            step += Group_Width;
+            pos   = (pos + step) & mask;
+        }
+    }
+
+    /* first empty or deleted slot on the probe sequence of hash */
+    template<class K, class V, class H>
+    size_t FlatTable<K, V, H>::find_slot(uint64_t hash) const
+    {
+        const auto mask = this->cap - 1;
+
+        auto pos  = hash & mask;
+        auto step = 0U;
+
+        while(true) {
+            auto free = Aux::CtrlGroup(this->ctrl + pos).match_free();
+
+            if(free) {
+                return (pos + Aux::trailing_zeros(free)) & mask;
+            }
+
+            step += Group_Width;
+            pos   = (pos + step) & mask;
+        }
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::set_ctrl(size_t index, int8_t val)
+    {
+        this->ctrl[index] = val;
+
+        if(index < Group_Width) {
+            this->ctrl[this->cap + index] = val;
+        }
+    }
+
+    template<class K, class V, class H>
+    V* FlatTable<K, V, H>::get(const K& key)
+    {
+        auto index = this->find(key, this->hash(key));
+
+        return index < this->cap ? &this->slots[index].val : nullptr;
+    }
+
+    template<class K, class V, class H> template<class KV, class... Args>
+    std::pair<bool, V*> FlatTable<K, V, H>::insert(KV&& key, Args&&... args)
+    {
+        return insert_hash(false, std::forward<KV>(key), std::forward<Args>(args)...);
+    }
+
+    template<class K, class V, class H> template<class KV, class... Args>
+    std::pair<bool, V*> FlatTable<K, V, H>::upsert(KV&& key, Args&&... args)
+    {
+        return insert_hash(true, std::forward<KV>(key), std::forward<Args>(args)...);
+    }
+
+    template<class K, class V, class H> template<class KV, class... Args>
+    std::pair<bool, V*> FlatTable<K, V, H>::insert_hash(bool update_on_dup, KV&& key, Args&&... args)
+    {
+        auto hash  = this->hash(key);
+        auto index = this->find(key, hash);
+
+        if(index < this->cap) {
+            auto& val = this->slots[index].val;
+
+            if(update_on_dup) {
+                V updated(std::forward<Args>(args)...);
+                val.~V();
+                new (&val) V(std::move(updated));
+            }
+
+            return { true, &val };
+        }
+
+        if(this->cap < 1) {
+            this->rehash(this->initial_cap);
+        }
+
+        index = this->find_slot(hash);
+
+        /* deleted slots are taken over, empty ones only while there is room left */
+        if(this->growth_left < 1 && this->ctrl[index] == Empty) {
+            /* mostly deleted slots are cleaned up in place */
+            this->rehash(this->elements * 16 < this->cap * 7 ? this->cap : this->cap * 2);
+            index = this->find_slot(hash);
+        }
+
+        /* the slot is only marked taken once its key and value are constructed */
+        auto* slot = new (&this->slots[index]) Slot (std::forward<KV>(key), std::forward<Args>(args)...);
+
+        if(this->ctrl[index] == Empty) {
+            this->growth_left--;
+        }
+
+        this->set_ctrl(index, (int8_t)(hash >> 57));
+        this->elements++;
+
+        return { false, &slot->val };
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::rehash(size_t new_cap)
+    {
+        if(this->cap > 0) {
+            SRL_COUNT(table_rehashes, 1);
+        }
+
+        auto n = Group_Width;
+        while(n < new_cap) {
+            n *= 2;
+        }
+
+        auto* old_ctrl  = this->ctrl;
+        auto* old_slots = this->slots;
+        auto  old_cap   = this->cap;
+
+        this->cap         = n;
+        this->ctrl        = this->heap.template get_mem<int8_t>(n + Group_Width);
+        this->slots       = this->heap.template get_mem<Slot>(n);
+        this->growth_left = n - n / 8 - this->elements;
+
+        memset(this->ctrl, Empty, n + Group_Width);
+
+        for(auto i = 0U; i < old_cap; i++) {
+            if(old_ctrl[i] < 0) {
+                continue;
+            }
+
+            auto& slot  = old_slots[i];
+            auto  hash  = this->hash(slot.key);
+            auto  index = this->find_slot(hash);
+
+            this->set_ctrl(index, (int8_t)(hash >> 57));
+            new (&this->slots[index]) Slot (std::move(slot.key), std::move(slot.val));
+            slot.~Slot();
+        }
+
+        if(old_cap > 0) {
+            this->heap.put_mem((uint8_t*)old_ctrl, old_cap + Group_Width);
+            this->heap.put_mem((uint8_t*)old_slots, old_cap * sizeof(Slot));
+        }
+    }
+
+    /* A slot whose neighbourhood never filled a whole group can't have been probed past, it becomes
+     * empty again. Otherwise it's marked deleted so probing continues behind it. */
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::erase(size_t index)
+    {
+        this->slots[index].~Slot();
+        this->elements--;
+
+        const auto mask = this->cap - 1;
+
+        auto empty_after  = Aux::CtrlGroup(this->ctrl + index).match(Empty);
+        auto empty_before = Aux::CtrlGroup(this->ctrl + ((index - Group_Width) & mask)).match(Empty);
+
+        auto never_full = empty_before && empty_after &&
+            Aux::trailing_zeros(empty_after) + Aux::leading_zeros(empty_before) < Group_Width;
+
+        if(never_full) {
+            this->growth_left++;
+            this->set_ctrl(index, Empty);
+
+        } else {
+            this->set_ctrl(index, Deleted);
+        }
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::remove(const K& key)
+    {
+        auto index = this->find(key, this->hash(key));
+
+        if(index < this->cap) {
+            this->erase(index);
+        }
+    }
+
+    template<class K, class V, class H>
+    std::optional<V> FlatTable<K, V, H>::extract(const K& key)
+    {
+        auto index = this->find(key, this->hash(key));
+
+        if(index < this->cap) {
+            V res = std::move(this->slots[index].val);
+            this->erase(index);
+
+            return res;
+        }
+
+        return { };
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::foreach_break(const std::function<bool(const K&, V&)>& fnc) const
+    {
+        for(auto i = 0U; i < this->cap; i++) {
+            if(this->ctrl[i] >= 0 && fnc(this->slots[i].key, this->slots[i].val)) {
+                return;
+            }
+        }
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::foreach(const std::function<void(const K&, V&)>& fnc) const
+    {
+        this->foreach_break([&fnc](const K& key, V& val)
+        {
+            fnc(key, val);
+            return false;
+        });
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::remove_if(const std::function<bool(const K&, V&)>& fnc)
+    {
+        for(auto i = 0U; i < this->cap; i++) {
+            if(this->ctrl[i] >= 0 && fnc(this->slots[i].key, this->slots[i].val)) {
+                this->erase(i);
+            }
+        }
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::reserve(size_t n_entries)
+    {
+        if(n_entries <= this->elements + this->growth_left) {
+            return;
+        }
+
+        /* at most 7 / 8 of the slots are taken */
+        this->rehash(n_entries + n_entries / 7 + 1);
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::clear()
+    {
+        if(this->elements < 1) {
+            return;
+        }
+
+        this->destroy_all();
+
+        memset(this->ctrl, Empty, this->cap + Group_Width);
+        this->elements    = 0;
+        this->growth_left = this->cap - this->cap / 8;
+    }
+
+    template<class K, class V, class H>
+    void FlatTable<K, V, H>::destroy_all()
+    {
+        if(std::is_trivially_destructible<Slot>::value) {
+            return;
+        }
+
+        for(auto i = 0U; i < this->cap; i++) {
+            if(this->ctrl[i] >= 0) {
+                this->slots[i].~Slot();
+            }
+        }
+    }
+
+    template<class K, class V, class H>
+    TableStats FlatTable<K, V, H>::stats() const
+    {
+        TableStats stats;
+        stats.entries = this->elements;
+        stats.buckets = this->cap;
+        stats.heap    = this->heap.stats();
+
+        if(this->cap < 1) {
+            return stats;
+        }
+
+        stats.load_factor = (double)this->elements / this->cap;
+
+        const auto mask = this->cap - 1;
+
+        for(auto i = 0U; i < this->cap; i++) {
+            if(this->ctrl[i] < 0) {
+                continue;
+            }
+
+            auto hash   = this->hash(this->slots[i].key);
+            auto pos    = hash & mask;
+            auto step   = 0U;
+            size_t groups = 1;
+
+            /* the group holding slot i is the first on the probe sequence covering it */
+            while(((i - pos) & mask) >= Group_Width) {
+                step += Group_Width;
+                pos   = (pos + step) & mask;
+                groups++;
+            }
+
+            stats.longest_chain = std::max(stats.longest_chain, groups);
+        }
+
+        return stats;
+    }
+
+    template<class K, class V, class H>
+    struct FlatTable<K, V, H>::Iterator {
+
+        Iterator() { }
+
+        Iterator(FlatTable<K, V, H>* tbl_) noexcept : tbl(tbl_), index(0)
+        {
+            skip();
+        }
+
+        bool operator!=(const Iterator& o) const noexcept
+        {
+            return this->current() != o.current();
+        }
+
+        Iterator& operator++() noexcept
+        {
+            if(this->current()) {
+                this->index++;
+                skip();
+            }
+
+            return *this;
+        }
+
+        std::pair<const K&, V&> operator*() const
+        {
+            auto* slot = this->current();
+
+            if(!slot) {
+                throw Srl::Exception("access iterator out of bounds");
+            }
+
+            return { slot->key, slot->val };
+        }
+
+    private:
+        FlatTable* tbl   = nullptr;
+        size_t     index = 0;
+
+        FlatTable::Slot* current() const noexcept
+        {
+            return this->tbl && this->index < this->tbl->cap ? &this->tbl->slots[this->index] : nullptr;
+        }
+
+        void skip() noexcept
+        {
+            while(this->tbl && this->index < this->tbl->cap && this->tbl->ctrl[this->index] < 0) {
+                this->index++;
+            }
+        }
+    };
+
 } }
 
 #endif
@@ -26,9 +26,6 @@ namespace Srl { namespace Lib {
 
             template<class Predicate>
             Link* find_rm (const Predicate& predicate);
-
-            template<class Predicate>
-            void  prepend (const Predicate& predicate, Link* link);
         };
     }
 
@@ -40,6 +37,10 @@ namespace Srl { namespace Lib {
         Heap() { }
         Heap(const Heap&) = default;
 
+        /* Without recycling memory is handed out in address order within each segment and freed
+         * blocks are dropped. Out reads its data back segment by segment. */
+        explicit Heap(bool recycle_) : recycle(recycle_) { }
+
         Heap(Heap&& m) { *this = std::forward<Heap>(m); };
         Heap& operator= (Heap&& m);
 
@@ -53,7 +54,41 @@ namespace Srl { namespace Lib {
 
         void put_mem(uint8_t* mem, size_t sz);
 
-        void clear();
+        static const size_t Keep_All = ~(size_t)0;
+
+        /* Rewinds all segments without zeroing them. Segments beyond keep_bytes are released,
+         * the largest ones are kept. */
+        void clear(size_t keep_bytes = Keep_All);
+
+        /* Segments are taken from one reserved range of address space of reserve_bytes from now on, pages are
+         * committed as the heap grows into it. With huge_pages the range is backed by transparent huge pages
+         * where the system has them. Segments are allocated as usual once the range is used up or where
+         * ranges can't be reserved. */
+        void reserve(size_t reserve_bytes, bool huge_pages = true);
+
+        /* reserved = used + free + wasted + untouched */
+        struct Stats {
+            size_t segments   = 0;
+            /* bytes in segments, committed pages of a reserved range */
+            size_t reserved   = 0;
+            /* handed out and not given back, including alignment padding */
+            size_t used       = 0;
+            /* given back and kept in the free lists */
+            size_t free       = 0;
+            /* given back but too small to be kept, tails of left segments without recycling */
+            size_t wasted     = 0;
+            /* not handed out since the last clear */
+            size_t untouched  = 0;
+            /* address space of a reserved range */
+            size_t address_space = 0;
+
+            size_t fragmented() const { return this->free + this->wasted; }
+
+            Stats& operator+= (const Stats& s);
+        };
+
+        /* walks segments and free lists, not meant for hot paths */
+        Stats stats() const;
 
         struct Segment {
 
@@ -63,17 +98,51 @@ namespace Srl { namespace Lib {
             uint8_t* data    = nullptr;
             uint32_t left    = 0;
             uint32_t size    = 0;
-            bool     sub_seg = false;
+            /* part of the reserved range */
+            bool     mapped  = false;
 
             void     dec (size_t n) { assert(this->left >= n); this->left -= n; }
             uint8_t* pointer()      { return data + size - left; }
         };
 
     private:
-        static const size_t Max_Cap = 65536 << 2;
+        static const size_t Max_Cap     = 65536 << 2;
+        static const size_t Initial_Cap = 256;
+        /* segments of the reserved range only cost committing their pages, they grow further */
+        static const size_t Max_Mapped_Cap = 1 << 26;
+
+        /* Freed blocks are kept in lists by size, up to Small_Limit in steps of Granule, above by power of two.
+         * A bit mask per kind marks the lists holding blocks, so taking and putting blocks doesn't search. */
+        static const size_t Granule     = sizeof(void*);
+        static const size_t Small_Lists = 64;
+        static const size_t Small_Limit = Small_Lists * Granule;
+        static const size_t Large_Lists = 64;
+
+        struct FreeBlock {
+            FreeBlock* next;
+            /* set for large blocks only */
+            size_t     size;
+        };
 
-        size_t   cap     = 256;
+        size_t   cap     = Initial_Cap;
         Segment* crr_seg = nullptr;
+        bool     recycle = true;
+
+        FreeBlock* small_free[Small_Lists] = { };
+        FreeBlock* large_free[Large_Lists] = { };
+        uint64_t   small_mask = 0;
+        uint64_t   large_mask = 0;
+        /* bytes given back but not kept since the last clear */
+        size_t     dropped    = 0;
+
+        struct Range {
+            uint8_t* begin     = nullptr;
+            size_t   size      = 0;
+            size_t   committed = 0;
+            /* the range as mapped, before aligning it */
+            uint8_t* mapping   = nullptr;
+            size_t   mapped    = 0;
+        } range;
 
         struct Chain {
 
@@ -89,6 +158,11 @@ namespace Srl { namespace Lib {
 
         Segment* alloc         (size_t sz, size_t align);
         Segment* find_free_seg (size_t sz, size_t align);
+        uint8_t* take_free     (size_t sz);
+        Segment* commit        (size_t sz);
+        bool     extend        (size_t sz);
+        void     clear_free    ();
+        void     trim          (size_t keep_bytes);
 
         void destroy();
     };
@@ -145,6 +219,14 @@ namespace Srl { namespace Lib {
 
 } }
 
+namespace Srl {
+
+    /* Segments of destroyed and trimmed heaps are pooled process wide and taken up by new heaps,
+     * sparing short-lived trees growing their heaps from scratch. Off by default, turning it off
+     * releases the pooled segments of the global pool and the calling thread. */
+    void pool_segments(bool enable = true);
+}
+
 #include "Heap.hpp"
 
 #endif
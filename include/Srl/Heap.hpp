@@ -10,6 +10,12 @@ namespace Srl { namespace Lib {
     {
         auto sz = n_elems * sizeof(T);
 
+        if(alignof(T) <= Granule && (this->small_mask | this->large_mask)) {
+            if(auto* mem = this->take_free(sz)) {
+                return reinterpret_cast<T*>(mem);
+            }
+        }
+
         if(!this->crr_seg || this->crr_seg->left < sz + alignof(T) - 1) {
             this->crr_seg = this->alloc(sz, alignof(T));
         }
@@ -3,5 +3,6 @@
 
 #include "In.hpp"
 #include "Out.hpp"
+#include "Pipeline.hpp"
 
 #endif
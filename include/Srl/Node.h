@@ -8,18 +8,26 @@
 #include "Environment.h"
 #include "Tree.h"
 #include "Union.h"
+#include "Fields.h"
 #include <optional>
 
 namespace Srl {
 
     class ScopeWrap;
 
+    namespace Lib {
+        struct FieldId;
+    }
+
     class Node {
 
         friend class Tree;
         template<class T, class U>
         friend struct Lib::Switch;
         friend struct Lib::Environment;
+        friend struct Lib::Pipeline;
+        template<class T>
+        friend struct Lib::FieldTable;
 
     public :
         Node(Tree& tree_) : Node(&tree_, Type::Object) {  }
@@ -63,11 +71,16 @@ namespace Srl {
         void paste() { }
 
         Node& node (const String& name);
+        Node& node (const Key& key);
         Node& node (size_t index);
 
         Value& value (const String& name);
+        Value& value (const Key& key);
         Value& value (size_t index);
 
+        /* element at index, packed arrays are read without unpacking them */
+        Value  element (size_t index);
+
         Union get(const String& name);
         Union get(size_t index);
 
@@ -98,6 +111,7 @@ namespace Srl {
 
         inline size_t num_nodes()    const;
         inline size_t num_values()   const;
+        inline bool   is_packed()    const;
 
         inline Type   type()         const;
         inline const  String& name() const;
@@ -113,15 +127,27 @@ namespace Srl {
             : env(&tree->get_env()), nodes(env->heap), values(env->heap),
               scope_type(type_), parsed(parsed_) { }
 
+        static const int Max_Scope_Depth = 128;
+
         Lib::Environment* env;
         Lib::Items<Node>  nodes;
         Lib::Items<Value> values;
 
+        Lib::Cursor<Node>  nodes_cursor;
+        Lib::Cursor<Value> values_cursor;
+
+        Lib::LinkIndex<Node>  nodes_index;
+        Lib::LinkIndex<Value> values_index;
+
         const String* name_ptr = nullptr;
 
         Type          scope_type;
         bool          parsed;
 
+        /* arrays of scalars are kept in a single block until an element is accessed by reference */
+        Type          packed_type = Type::Null;
+        Lib::MemBlock packed;
+
         template<class... Args>
         void open_scope (void (*Insert)(Node& node, const Args&... args),
                          Type node_type, const String& name, const Args&... args);
@@ -132,14 +158,42 @@ namespace Srl {
         Node& insert_node  (const Node& node, const String& name);
         Node& insert_node  (Type type, const String& name);
         void  insert_value (const Value& value, const String& name);
+        void  insert_array (const Value& array, const String& name);
+
+        void  unpack ();
+        Value packed_value () const;
+
+        template<class E>
+        bool  insert_packed (const E* elems, size_t count, const String& name);
 
+        template<class E>
+        void  paste_packed  (E* elems);
+
+        void             rebind      (Lib::Environment* env_);
+
+        Node             child_node  (const Value& scope_start);
+        Lib::Link<Node>* store_scope (const Value& scope_start, const String& name, int scope_depth = 0);
+
+        /* through the pipeline of the parser in use */
         void  to_source   ();
         void  read_source (int scope_depth = 0);
 
+        /* defined in Pipeline.hpp */
+        template<class TParser>
+        void  write_scope (TParser& parser);
+        template<class TParser>
+        void  read_scope  (TParser& parser, int scope_depth);
+
         void  consume_scope ();
         Node  consume_node  (bool throw_ex, const String& name);
         Value consume_value (bool throw_ex, const String& name);
 
+        Node  consume_node  (bool throw_ex, const Key& key);
+        Value consume_value (bool throw_ex, const Key& key);
+
+        Node  consume_node  (bool throw_ex, Lib::FieldId& id);
+        Value consume_value (bool throw_ex, Lib::FieldId& id);
+
         Node  consume_node  (bool throw_ex, size_t idx);
         Value consume_value (bool throw_ex, size_t idx);
 
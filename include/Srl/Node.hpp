@@ -83,6 +83,7 @@ namespace Srl {
     template<class T>
     void Node::paste(T& o)
     {
+        Lib::Aux::adopt_resource(o, this->env->resource);
         Lib::Switch<T>::Paste(o, *this);
     }
 
@@ -106,6 +107,8 @@ namespace Srl {
     typename std::enable_if<!std::is_same<T, Srl::Union>::value && TpTools::is_scope(Lib::Switch<T>::type), void>::type
     Node::paste_field (const ID& fieldID, T& o)
     {
+        Lib::Aux::adopt_resource(o, this->env->resource);
+
         if(this->parsed) {
             Lib::Switch<T>::Paste(o, this->node(fieldID), fieldID);
 
@@ -120,6 +123,8 @@ namespace Srl {
     typename std::enable_if<!std::is_same<T, Srl::Union>::value && !TpTools::is_scope(Lib::Switch<T>::type), void>::type
     Node::paste_field (const ID& fieldID, T& o)
     {
+        Lib::Aux::adopt_resource(o, this->env->resource);
+
         if(this->parsed) {
             Lib::Switch<T>::Paste(o, this->value(fieldID), fieldID);
 
@@ -153,6 +158,36 @@ namespace Srl {
         }
     }
 
+    template<class E>
+    bool Node::insert_packed(const E* elems, size_t count, const String& scope_name)
+    {
+        auto size = count * sizeof(E);
+
+        if(size > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+
+        Lib::MemBlock block(reinterpret_cast<const uint8_t*>(elems), size);
+        this->insert_array(Value(block, Type::Array, TpTools::SrlType<E>::type), scope_name);
+
+        return true;
+    }
+
+    template<class E>
+    void Node::paste_packed(E* elems)
+    {
+        if(this->packed_type == TpTools::SrlType<E>::type) {
+            if(this->packed.size > 0) {
+                memcpy(elems, this->packed.ptr, this->packed.size);
+            }
+            return;
+        }
+
+        for(size_t i = 0, n = this->num_values(); i < n; i++) {
+            Lib::Switch<E>::Paste(elems[i], this->element(i), i);
+        }
+    }
+
     template<class T>
     typename std::enable_if<!TpTools::is_scope(Lib::Switch<T>::type), Value>::type
     Node::consume_item()
@@ -194,6 +229,8 @@ namespace Srl {
     template<class TParser>
     void Node::to_source(Lib::Out::Source source, TParser&& parser)
     {
+        SRL_SPAN(store_ns);
+
         this->env->set_output(parser, source);
         this->to_source();
         this->env->out.flush();
@@ -207,7 +244,14 @@ namespace Srl {
 
     inline size_t Node::num_values() const
     {
-        return this->values.size();
+        return this->is_packed()
+            ? this->packed.size / TpTools::get_size(this->packed_type)
+            : this->values.size();
+    }
+
+    inline bool Node::is_packed() const
+    {
+        return this->packed_type != Type::Null;
     }
 
     inline const String& Node::name() const
@@ -40,6 +40,8 @@ namespace Srl { namespace Lib {
 
         void set(Source source);
 
+        Heap::Stats heap_stats() const { return this->heap.stats(); }
+
         class Ticket {
 
         friend class Out;
@@ -58,7 +60,7 @@ namespace Srl { namespace Lib {
     private:
         static const size_t Stream_Buffer_Size  = 1024;
 
-        Heap   heap;
+        Heap   heap { false };
 
         struct State {
             size_t sz_total     = 0;
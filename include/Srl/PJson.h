@@ -5,7 +5,7 @@
 
 namespace Srl {
 
-    class PJson : public Parser {
+    class PJson final : public Parser {
 
     public :
         PJson(bool compact_ = true)
@@ -19,6 +19,12 @@ namespace Srl {
         virtual std::pair<Lib::MemBlock, Value> read(Lib::In& source) override;
         virtual void clear() override;
 
+        std::vector<size_t> scan_array(const Lib::MemBlock& source) override;
+        bool resumes() const override { return true; }
+        void resume(const Parser& scanner, size_t mark) override;
+
+        const Lib::Pipeline& pipeline() const override;
+
     private :
         bool             compact;
         std::stack<Type> scope_stack;
@@ -50,7 +56,7 @@ namespace Srl {
         void process_bracket (char bracket, State& state);
         void process_char    (Lib::In& source, State& state, bool& out_move);
 
-        void process_string  (const Lib::MemBlock& str, State& state);
+        void process_string  (const Lib::MemBlock& str, State& state, bool borrowed);
         void process_literal (const Lib::MemBlock& str, State& state, Type hint);
 
         void throw_exception (State& state, const String& info);
@@ -6,7 +6,7 @@
 
 namespace Srl {
 
-    class PMsgPack : public Parser {
+    class PMsgPack final : public Parser {
 
     public :
         PMsgPack() { }
@@ -18,6 +18,8 @@ namespace Srl {
         virtual std::pair<Lib::MemBlock, Value> read (Lib::In& source) override;
         virtual void clear() override;
 
+        const Lib::Pipeline& pipeline() const override;
+
     private:
         struct Scope {
             Scope(Type type_, size_t elements_, const Lib::Out::Ticket& ticket_ = { })
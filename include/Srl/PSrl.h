@@ -12,35 +12,45 @@ namespace Srl {
         template<> struct HashSrl<MemBlock> {
             inline size_t operator() (const MemBlock& s) const
             {
-                return Aux::hash_fnc(s.ptr, s.size);
+                return Aux::hash_seeded(s.ptr, s.size);
             }
         };
     }
 
-    class PSrl : public Parser {
+    class PSrl final : public Parser {
 
     public :
         PSrl() { }
 
         Format get_format() const override { return Format::Binary; }
+        bool   packs_arrays() const override { return true; }
+        bool   interns_type_ids() const override { return true; }
 
         virtual void
         write(const Value& value, const Lib::MemBlock& name, Lib::Out& out) override;
         virtual std::pair<Lib::MemBlock, Value> read(Lib::In& source) override;
         virtual void clear() override;
 
+        bool   resumes() const override { return true; }
+        size_t mark() const override { return this->indexed_strings.size(); }
+        void   resume(const Parser& scanner, size_t mark) override;
+
+        const Lib::Pipeline& pipeline() const override;
+
     private :
         Type scope = Type::Null;
 
-        std::vector<Lib::MemBlock>         indexed_strings;
-        Lib::Heap                          string_buffer;
-        std::stack<Type>                   scope_stack;
-        Lib::HTable<Lib::MemBlock, size_t> hashed_strings;
+        std::vector<Lib::MemBlock>            indexed_strings;
+        Lib::Heap                             string_buffer;
+        std::stack<Type>                      scope_stack;
+        Lib::FlatTable<Lib::MemBlock, size_t> hashed_strings;
 
         void push_scope (Type scope_type);
         void pop_scope  ();
 
-        std::pair<Lib::MemBlock, Value> read_num (uint8_t flag, const Lib::MemBlock& name, Lib::In& source);
+        std::pair<Lib::MemBlock, Value> read_num     (uint8_t flag, const Lib::MemBlock& name, Lib::In& source);
+        std::pair<Lib::MemBlock, Value> read_packed  (const Lib::MemBlock& name, Lib::In& source);
+        std::pair<Lib::MemBlock, Value> read_type_id (uint8_t flag, const Lib::MemBlock& name, Lib::In& source);
 
         void write_head (uint8_t flag, const Lib::MemBlock& str, Lib::Out& out);
         std::pair<uint8_t, Lib::MemBlock> read_head (Lib::In& source);
@@ -9,16 +9,34 @@ namespace Srl {
     namespace Lib {
         class In;
         class Out;
+        struct Pipeline;
     }
 
     struct Parser {
 
         virtual Format get_format() const = 0;
+        /* parsers which can't write packed scalar arrays get them element by element */
+        virtual bool   packs_arrays() const { return false; }
+        /* parsers with an encoding of their own for interned polymorphic type ids, see Value::as_type_id */
+        virtual bool   interns_type_ids() const { return false; }
 
         virtual void write(const Value& value, const Lib::MemBlock& name, Lib::Out& out) = 0;
         virtual std::pair<Lib::MemBlock, Value> read(Lib::In& source) = 0;
         virtual void clear() = 0;
 
+        /* Parallel loading of top level arrays. Parsers which find the elements faster than by parsing
+         * them return their offsets in source followed by the offset of the array end, others nothing. */
+        virtual std::vector<size_t> scan_array(const Lib::MemBlock&) { return { }; }
+        /* parsers able to continue reading at an element of a top level array read by another parser */
+        virtual bool   resumes() const { return false; }
+        /* parse state at the start of an element */
+        virtual size_t mark() const { return 0; }
+        virtual void   resume(const Parser&, size_t) { }
+
+        /* Loading and writing documents instantiated for the parser type, so the parser functions called per
+         * token can be inlined. The default pipeline goes through the virtual functions above. */
+        virtual const Lib::Pipeline& pipeline() const;
+
         virtual ~Parser() = default;
     };
 }
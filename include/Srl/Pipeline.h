@@ -0,0 +1,33 @@
+#ifndef SRL_PIPELINE_H
+#define SRL_PIPELINE_H
+
+#include "Blocks.h"
+#include "Value.h"
+#include "String.h"
+
+namespace Srl {
+
+    class Node;
+
+namespace Lib {
+
+    struct Environment;
+
+    /* The functions of environment and nodes calling the parser per token, instantiated for one parser type.
+     * Instantiated in the translation unit defining the parser the parser calls are direct and can be
+     * inlined, environment and nodes pick the pipeline of their parser once per document. */
+    struct Pipeline {
+
+        std::pair<MemBlock, Value> (*read) (Environment& env);
+
+        void (*write)       (Environment& env, const Value& value, const String& name);
+        void (*read_source) (Node& node, int scope_depth);
+        void (*to_source)   (Node& node);
+
+        /* defined in Pipeline.hpp */
+        template<class TParser>
+        static const Pipeline& of();
+    };
+} }
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef SRL_PIPELINE_HPP
+#define SRL_PIPELINE_HPP
+
+#include "Pipeline.h"
+#include "Environment.h"
+#include "Node.h"
+#include "Tools.h"
+
+namespace Srl { namespace Lib {
+
+    template<class TParser>
+    const Pipeline& Pipeline::of()
+    {
+        static const Pipeline pipeline {
+            [](Environment& env) {
+                return env.read(static_cast<TParser&>(*env.parser));
+            },
+            [](Environment& env, const Value& value, const String& name) {
+                env.write(static_cast<TParser&>(*env.parser), value, name);
+            },
+            [](Node& node, int scope_depth) {
+                node.read_scope(static_cast<TParser&>(*node.env->parser), scope_depth);
+            },
+            [](Node& node) {
+                node.write_scope(static_cast<TParser&>(*node.env->parser));
+            }
+        };
+
+        return pipeline;
+    }
+
+    template<class TParser>
+    std::pair<MemBlock, Value> Environment::read(TParser& parser_)
+    {
+        SRL_COUNT(parser_reads, 1);
+        SRL_SPAN(parse_ns);
+
+        auto seg = parser_.read(this->in);
+
+        if(this->intern_type_ids && seg.second.is_type_id()) {
+            this->read_type_id(seg.second);
+        }
+
+        return seg;
+    }
+
+    template<class TParser>
+    void Environment::write(TParser& parser_, const Value& value, const String& field_name)
+    {
+        if(this->intern_type_ids && value.is_type_id() && value.type() == Type::String) {
+            this->write_type_id(parser_, value, field_name);
+            return;
+        }
+
+        if(value.elem_type() != Type::Null && !parser_.packs_arrays()) {
+            this->write_elems(parser_, value, field_name);
+            return;
+        }
+
+        this->write_conv(parser_, value, field_name);
+    }
+
+    template<class TParser>
+    void Environment::write_type_id(TParser& parser_, const Value& type_id, const String& field_name)
+    {
+        String id(type_id.data(), type_id.size(), type_id.encoding());
+        auto* index = this->type_ids_out.get(id);
+
+        if(index) {
+            this->write_conv(parser_, Value(*index).as_type_id(), field_name);
+            return;
+        }
+
+        /* the id may not outlive the document */
+        String stored(Aux::copy(this->heap, { type_id.data(), type_id.size() }), type_id.encoding());
+        this->type_ids_out.insert(stored, (uint32_t)this->type_ids_out.num_entries());
+
+        this->write_conv(parser_, type_id, field_name);
+    }
+
+    template<class TParser>
+    void Environment::write_elems(TParser& parser_, const Value& array, const String& field_name)
+    {
+        auto elem_size = TpTools::get_size(array.elem_type());
+
+        this->write_conv(parser_, Value(Type::Array), field_name);
+
+        for(size_t offset = 0; offset < array.size(); offset += elem_size) {
+            this->write_conv(parser_, Tools::bytes_to_type(array.data() + offset, array.elem_type()), EmptyString);
+        }
+
+        this->write_conv(parser_, Value(Type::Scope_End), field_name);
+    }
+
+    template<class TParser>
+    void Environment::write_conv(TParser& parser_, const Value& value, const String& val_name)
+    {
+        MemBlock name_conv;
+
+        if(val_name.encoding() == Encoding::UTF8) {
+            name_conv = MemBlock(val_name.data(), val_name.size());
+
+        } else {
+            auto& buffer = this->str_buffer;
+            auto size = Tools::conv_charset(Encoding::UTF8, val_name, buffer, true);
+            name_conv = MemBlock(buffer.data(), size);
+        }
+
+        auto type   = value.type();
+        auto format = parser_.get_format();
+
+        bool no_conversion_needed =
+            /* scope types don't need conversion */
+            TpTools::is_scope(type) || type == Type::Scope_End ||
+            /* strings must be UTF8 in text formats */
+            (type == Type::String && format != Format::Text &&
+             value.encoding() == Encoding::UTF8) ||
+            /* binary types must be converted to string in text formats */
+            (type != Type::String && format == Format::Binary);
+
+        SRL_COUNT(parser_writes, 1);
+        SRL_SPAN(write_ns);
+
+        if(no_conversion_needed) {
+            parser_.write(value, name_conv, this->out);
+
+        } else {
+            parser_.write(this->conv_type(value), name_conv, this->out);
+        }
+    }
+}
+
+    template<class TParser>
+    void Node::read_scope(TParser& parser, int scope_depth)
+    {
+        while(true) {
+
+            Lib::MemBlock seg_name; Value val;
+            std::tie(seg_name, val) = this->env->read(parser);
+
+            if(val.type() == Type::Scope_End) {
+                this->parsed = true;
+                break;
+            }
+
+            auto field_name = String(seg_name, Encoding::UTF8);
+
+            if(!TpTools::is_scope(val.type())) {
+                this->env->store_value(*this, val, field_name);
+                continue;
+            }
+
+            if(scope_depth + 1 > Max_Scope_Depth) {
+                throw Exception("Abort parsing data, maximum nesting depth [" +
+                                std::to_string(Max_Scope_Depth) + "] exceeded");
+            }
+
+            /* packed arrays are complete once read */
+            if(val.elem_type() != Type::Null) {
+                this->env->store_array(*this, val, field_name);
+                continue;
+            }
+
+            auto* link = this->env->store_node(*this, Node(this->env->tree, val.type()), field_name);
+            link->field.read_scope(parser, scope_depth + 1);
+        }
+    }
+
+    template<class TParser>
+    void Node::write_scope(TParser& parser)
+    {
+        if(this->is_packed()) {
+            this->env->write(parser, this->packed_value(), this->name());
+            return;
+        }
+
+        this->env->write(parser, Value(this->scope_type), this->name());
+
+        for(auto& v : this->values) {
+            this->env->write(parser, v.field, v.field.name());
+        }
+
+        for(auto& n : this->nodes) {
+            n.field.write_scope(parser);
+        }
+
+        this->env->write(parser, Value(Type::Scope_End), *this->name_ptr);
+    }
+}
+
+#endif
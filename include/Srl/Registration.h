@@ -5,6 +5,10 @@
 #include "Hash.hpp"
 #include "Exception.h"
 #include "Resolve.h"
+#include "Fields.h"
+
+#include <atomic>
+#include <mutex>
 
 namespace Srl {
 
@@ -12,15 +16,25 @@ namespace Srl {
 
     namespace Lib {
 
+        /* Types are looked up from any number of threads without locking or waiting, while others
+         * register types, e.g. of plugins loaded later on. Registering is serialized. Entries and the
+         * index over them are never changed once published, a growing index is replaced as a whole
+         * and the previous ones are kept, so readers still holding them stay valid. */
         class Registrations {
 
-            typedef std::function<void*(void)> Make;
+            typedef void* (*Make)();
 
         public:
+            Registrations();
+            ~Registrations();
+
+            Registrations(const Registrations&) = delete;
+            Registrations& operator= (const Registrations&) = delete;
+
             template<class T>
             void add(const String& id)
             {
-                bool exists = this->insert(id, [] { return Ctor<T>::Create_New().release(); });
+                bool exists = this->insert(id, &Registrations::make<T>);
 
                 if(exists) {
                     throw Exception("Class id " + id.unwrap(false) + " duplicated.");
@@ -30,25 +44,120 @@ namespace Srl {
             template<class T>
             std::unique_ptr<T> create(const String& id)
             {
-                auto* make = this->find(id);
-
-                if(!make) {
-                    throw Exception("Class id " + id.unwrap(false) + " not registered.");
-                }
+                return this->create<T>(this->slot(id));
+            }
 
-                auto* ptr = (T*)((*make)());
+            /* slots are dense indices of the registered types */
+            template<class T>
+            std::unique_ptr<T> create(size_t slot)
+            {
+                auto* ptr = (T*)(this->entry(slot).make());
                 return std::unique_ptr<T>(ptr);
             }
 
+            size_t slot (const String& id);
+            /* with the hash of the id computed up front, e.g. by Aux::hash_literal */
+            size_t slot (const String& id, uint64_t hash);
+
         private:
-            HTable<String, Make> table { 16 };
+            struct Entry {
+                std::string id;
+                uint64_t    hash = 0;
+                size_t      slot = 0;
+                Make        make = nullptr;
+            };
+
+            /* open addressing, buckets only ever change from empty to an entry */
+            struct Index {
+                Index(size_t cap_) : cap(cap_), buckets(new std::atomic<const Entry*>[cap_]()) { }
+
+                const size_t cap;
+                std::unique_ptr<std::atomic<const Entry*>[]> buckets;
+            };
 
-            bool  insert (const String& id, Make&& make);
-            Make* find   (const String& id);
+            /* chunk k holds First_Chunk << k entries, chunks don't move once allocated */
+            static const size_t First_Chunk = 16;
+            static const size_t Chunks      = 40;
+
+            std::atomic<Entry*> chunks[Chunks];
+            std::atomic<Index*> index { nullptr };
+            size_t              n_entries = 0;
+
+            /* the current index and the ones replaced */
+            std::vector<std::unique_ptr<Index>> indices;
+            std::mutex                          mutex;
+
+            template<class T>
+            static void* make() { return Ctor<T>::Create_New().release(); }
+
+            bool         insert  (const String& id, Make make_);
+            const Entry& entry   (size_t slot) const;
+            void         grow    ();
+            void         place   (Index* idx, const Entry& entry);
+            size_t       slot_of (const Index* idx, const String& id, uint64_t hash) const;
         };
 
         Registrations* registrations();
 
+        /* Names shared by all trees of the process, e.g. the field names of a schema. Trees point
+         * their fields to the interned names instead of copying them into their own string table.
+         * Lookups don't lock, names are never removed and don't move, a growing index is replaced
+         * as a whole like the one of the registrations. */
+        class InternedNames {
+
+        public:
+            InternedNames() { }
+
+            InternedNames(const InternedNames&) = delete;
+            InternedNames& operator= (const InternedNames&) = delete;
+
+            void add (const std::vector<String>& names);
+
+            /* the names listed in SRL_FIELDS of T */
+            template<class T>
+            void add_fields()
+            {
+                std::apply([this](const auto&... field) {
+                    this->add({ String(field.key)... });
+                }, T::srl_fields());
+            }
+
+            /* name in UTF-8 and its hash by Aux::hash_fnc, nullptr if the name isn't interned */
+            const String* find (const MemBlock& name, uint64_t hash) const;
+
+            size_t size () const { return this->n_names.load(std::memory_order_relaxed); }
+
+        private:
+            struct Entry {
+                String   name;
+                uint64_t hash = 0;
+            };
+
+            /* open addressing, buckets only ever change from empty to an entry */
+            struct Index {
+                Index(size_t cap_) : cap(cap_), buckets(new std::atomic<const Entry*>[cap_]()) { }
+
+                const size_t cap;
+                std::unique_ptr<std::atomic<const Entry*>[]> buckets;
+            };
+
+            static const size_t First_Cap = 64;
+
+            std::deque<Entry>   entries;
+            Heap                heap;
+            std::atomic<Index*> index   { nullptr };
+            std::atomic<size_t> n_names { 0 };
+
+            std::vector<std::unique_ptr<Index>> indices;
+            std::vector<uint8_t>                buffer;
+            std::mutex                          mutex;
+
+            void grow  ();
+            void place (Index* idx, const Entry& entry);
+        };
+
+        InternedNames* interned_names();
+
         template<class T>
         class TypeRegistration : public TypeID {
 
@@ -59,6 +168,10 @@ namespace Srl {
             TypeRegistration(const char* type_id_) : type_id(type_id_)
             {
                 Lib::registrations()->add<T>(type_id);
+
+                if constexpr(has_fields_method<T>::value) {
+                    Lib::interned_names()->add_fields<T>();
+                }
             }
 
             const char* name() const override { return this->type_id; }
@@ -70,6 +183,17 @@ namespace Srl {
     {
         return Lib::TypeRegistration<T>(type_id);
     }
+
+    /* Interns names process wide, trees loading or storing fields of these names neither hash them
+     * into their string table nor copy them. Meant for the fixed names of a schema, interned names
+     * are kept until the process exits. Registered types with SRL_FIELDS have their fields interned. */
+    void intern_names(const std::vector<String>& names);
+
+    template<class T>
+    void intern_fields()
+    {
+        Lib::interned_names()->add_fields<T>();
+    }
 }
 
 #endif
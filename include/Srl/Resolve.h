@@ -6,6 +6,11 @@
 #include "Type.h"
 
 #include <memory>
+#include <memory_resource>
+#include <string_view>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 namespace Srl {
 
@@ -36,6 +41,19 @@ namespace Lib {
 
     template<class TChar> Encoding get_encoding();
 
+    namespace Aux {
+        /* creates restored objects, allocator-aware ones with the given allocator */
+        template<class T, class Alloc>
+        T create_using(const Alloc& alloc);
+
+        template<class T>
+        T create_like(const T& container);
+
+        /* rebuilds std::pmr strings and containers not allocating from resource, if any, with it */
+        template<class T>
+        void adopt_resource(T& o, std::pmr::memory_resource* resource);
+    }
+
     template<class T> struct has_store_method {
 
         template<class U, U> struct test_sig { };
@@ -84,6 +102,17 @@ namespace Lib {
         static const bool value = sizeof(test<T>(0)) == sizeof(char);
     };
 
+    /* declared by SRL_FIELDS */
+    template<class T> struct has_fields_method {
+
+        template<class U>
+        static char test(decltype(&U::srl_fields));
+        template<class U>
+        static long test(...);
+
+        static const bool value = sizeof(test<T>(0)) == sizeof(char);
+    };
+
     /* Switch<T> resolves types. Basically it tells Srl::Node how to
      * store and restore types.
      * 'Batteries included'-specializations are implemented in Resolve.hpp.
@@ -134,20 +163,65 @@ namespace Lib {
         static const bool value = true;
     };
 
+    template<class T> struct is_pair {
+        static const bool value = false;
+    };
+
+    template<class F, class S> struct is_pair<std::pair<F, S>> {
+        static const bool value = true;
+    };
+
     template<class T> struct is_basic_string {
         static const bool value = false;
     };
 
-    template<class T> struct is_basic_string<std::basic_string<T>> {
+    template<class C, class Tr, class A> struct is_basic_string<std::basic_string<C, Tr, A>> {
+        static const bool value = true;
+    };
+
+    /* views restore by pointing into the source instead of copying */
+    template<class T> struct is_view {
+        static const bool value = false;
+    };
+
+    template<class C, class Tr> struct is_view<std::basic_string_view<C, Tr>> {
         static const bool value = true;
     };
 
+#if __cplusplus >= 202002L
+    template<class E, size_t N> struct is_view<std::span<E, N>> {
+        static const bool value = true;
+    };
+#endif
+
+    template<class T> struct has_allocator {
+        template <class U> static char test(typename U::allocator_type*);
+        template <class U> static long test(...);
+        static const bool value = sizeof(test<T>(0)) == sizeof(char);
+    };
+
+    /* allocator-aware types whose allocator can be made from a memory resource, like the std::pmr ones */
+    template<class T> struct has_resource_allocator {
+        template <class U, class = decltype(std::declval<const U&>().get_allocator()
+                                            == typename U::allocator_type(std::declval<std::pmr::memory_resource*>()))>
+        static char test(int);
+        template <class U> static long test(...);
+        static const bool value = sizeof(test<T>(0)) == sizeof(char);
+    };
+
+    /* node based associative containers, their nodes can be moved between containers */
+    template<class T> struct has_node_handle {
+        template <class U> static char test(typename U::node_type*);
+        template <class U> static long test(...);
+        static const bool value = sizeof(test<T>(0)) == sizeof(char);
+    };
+
     template<class T, typename = void> struct is_container {
         static const bool value = false;
     };
 
     template<class T>
-    struct is_container<T, typename std::enable_if<has_iterator<T>::value && !is_basic_string<T>::value>::type> {
+    struct is_container<T, typename std::enable_if<has_iterator<T>::value && !is_basic_string<T>::value && !is_view<T>::value>::type> {
 
         typedef typename T::const_iterator I;
 
@@ -197,6 +271,21 @@ namespace Lib {
             (std::is_floating_point<T>::value || std::is_integral<T>::value);
     };
 
+    /* numeric types which can be stored as elements of a packed array */
+    template<class T> struct is_packable {
+        static const bool value =
+            is_numeric<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, long double>::value;
+    };
+
+    /* contiguous containers of packable elements */
+    template<class T> struct is_packed_container {
+        static const bool value = false;
+    };
+
+    template<class T, class A> struct is_packed_container<std::vector<T, A>> {
+        static const bool value = is_packable<T>::value;
+    };
+
 } }
 
 
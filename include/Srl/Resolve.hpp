@@ -12,6 +12,8 @@
 #include "TpTools.h"
 #include "Registration.h"
 
+#include <new>
+
 namespace Srl { namespace Lib {
 
     namespace Aux {
@@ -80,18 +82,18 @@ namespace Srl { namespace Lib {
              : Encoding::Unknown;
     }
 
-    /* handle std::basic_string<T> types */
-    template<class T>
-    struct Switch<std::basic_string<T>> {
+    /* handle std::basic_string<T> types, whatever their allocator */
+    template<class T, class Tr, class A>
+    struct Switch<std::basic_string<T, Tr, A>> {
         static const Type type = Type::String;
 
-        static void Insert(const std::basic_string<T>& str, Node& node, const String& name)
+        static void Insert(const std::basic_string<T, Tr, A>& str, Node& node, const String& name)
         {
             auto pair = Wrap(str);
             node.insert_value(Value(pair.second, pair.first), name);
         }
 
-        static std::pair<Encoding, MemBlock> Wrap(const std::basic_string<T>& str)
+        static std::pair<Encoding, MemBlock> Wrap(const std::basic_string<T, Tr, A>& str)
         {
             return std::make_pair (
                 get_encoding<T>(),
@@ -100,7 +102,7 @@ namespace Srl { namespace Lib {
         }
 
         template<class ID = String>
-        static void Paste(std::basic_string<T>& str, const Value& value, const ID& id = Aux::str_empty)
+        static void Paste(std::basic_string<T, Tr, A>& str, const Value& value, const ID& id = Aux::str_empty)
         {
             auto val_type = value.type();
 
@@ -108,8 +110,13 @@ namespace Srl { namespace Lib {
                 return;
             }
 
-            if(val_type == Type::String) {
-                str = String(value.data(), value.size(), value.encoding()).unwrap<T>();
+            if(val_type == Type::String && value.encoding() == get_encoding<T>()) {
+                /* assign keeps the capacity of the string */
+                str.assign(reinterpret_cast<const T*>(value.data()), value.size() / sizeof(T));
+
+            } else if(val_type == Type::String) {
+                auto conv = String(value.data(), value.size(), value.encoding()).unwrap<T>();
+                str.assign(conv.data(), conv.size());
 
             } else {
                 /* convert literal to string */
@@ -117,10 +124,66 @@ namespace Srl { namespace Lib {
                 Aux::check_size(TpTools::get_size(val_type), value.size(), id);
 
                 auto tmp_string = Tools::type_to_str(value);
-                str = String(tmp_string).unwrap<T>();
+                auto conv = String(tmp_string).unwrap<T>();
+                str.assign(conv.data(), conv.size());
+            }
+        }
+    };
+
+    /* string views point straight into the source, the source must outlive the restored object */
+    template<class T, class Tr>
+    struct Switch<std::basic_string_view<T, Tr>> {
+        static const Type type = Type::String;
+
+        static void Insert(const std::basic_string_view<T, Tr>& str, Node& node, const String& name)
+        {
+            MemBlock block(reinterpret_cast<const uint8_t*>(str.data()), str.size() * sizeof(T));
+            node.insert_value(Value(block, get_encoding<T>()), name);
+        }
+
+        template<class ID = String>
+        static void Paste(std::basic_string_view<T, Tr>& str, const Value& value, const ID& id = Aux::str_empty)
+        {
+            if(value.type() == Type::Null) {
+                return;
+            }
+
+            if(value.type() != Type::String || value.encoding() != get_encoding<T>() || !value.borrowed()) {
+                Aux::throw_error("Unable to restore string view. The string must be stored verbatim "
+                                 "in a non-streaming source in the encoding of the view.", id);
+            }
+
+            str = std::basic_string_view<T, Tr>(reinterpret_cast<const T*>(value.data()), value.size() / sizeof(T));
+        }
+    };
+
+#if __cplusplus >= 202002L
+    /* spans over binary data point straight into the source, the source must outlive the restored object */
+    template<>
+    struct Switch<std::span<const uint8_t>> {
+        static const Type type = Type::Binary;
+
+        static void Insert(const std::span<const uint8_t>& span, Node& node, const String& name)
+        {
+            node.insert_value(Value(MemBlock(span.data(), span.size()), Type::Binary), name);
+        }
+
+        template<class ID = String>
+        static void Paste(std::span<const uint8_t>& span, const Value& value, const ID& id = Aux::str_empty)
+        {
+            if(value.type() == Type::Null) {
+                return;
             }
+
+            if(value.type() != Type::Binary || !value.borrowed()) {
+                Aux::throw_error("Unable to restore span. The data must be stored as binary "
+                                 "in a non-streaming source.", id);
+            }
+
+            span = std::span<const uint8_t>(value.data(), value.size());
         }
     };
+#endif
 
     /* single characters are also strings */
     template<class T>
@@ -438,8 +501,8 @@ namespace Srl { namespace Lib {
         static void Insert(Node& node, const T& o)
         {
             Context ctx(node, Mode::Insert);
-            auto* id = o->srl_type_id().name();
-            ctx(Aux::str_type_id, id);
+            auto id = wrap_string(o->srl_type_id().name());
+            node.insert_value(Value(id.second, id.first).as_type_id(), Aux::str_type_id);
 
             const_cast<T>(o)->srl_resolve(ctx);
         }
@@ -451,16 +514,22 @@ namespace Srl { namespace Lib {
 
             Aux::check_type_scope(node.type(), id);
 
+            /* interned ids of binary formats dispatch without touching the id string */
+            auto type_id = node.parsed ? node.value(Aux::str_type_id)
+                                       : node.consume_value(true, Aux::str_type_id);
             Context ctx(node, Mode::Paste);
-            String type_id;
-            ctx(Aux::str_type_id, type_id);
 
-            if(o != nullptr) {
-                delete o;
+            if(o != nullptr && node.env->reuse_objects && node.env->type_name(type_id) == String(o->srl_type_id().name())) {
+                o->srl_resolve(ctx);
+                return;
             }
 
-            auto uptr = Lib::registrations()->create<U>(type_id);
+            auto uptr = Lib::registrations()->create<U>(node.env->type_slot(type_id));
             uptr->srl_resolve(ctx);
+
+            if(o != nullptr) {
+                delete o;
+            }
             o = uptr.release();
         }
     };
@@ -471,8 +540,18 @@ namespace Srl { namespace Lib {
         static const Type type = Type::Array;
         typedef typename T::value_type E;
 
+        /* sequence containers can be restored into their existing elements */
+        static constexpr bool In_Place =
+            !std::is_same<typename T::const_iterator, typename T::iterator>::value && !is_pair<E>::value;
+
         static void Insert(const T& container, Node& node, const String& name)
         {
+            if constexpr(is_packed_container<T>::value) {
+                if(node.insert_packed(container.data(), container.size(), name)) {
+                    return;
+                }
+            }
+
             node.open_scope(&Insert, type, name, container);
         }
 
@@ -496,10 +575,27 @@ namespace Srl { namespace Lib {
         {
             Aux::check_type_scope(node.type(), id);
 
-            T new_cont;
+            if constexpr(In_Place) {
+                if(node.env->reuse_objects) {
+                    PasteInPlace(c, node);
+                    return;
+                }
+            }
+
+            if constexpr(has_node_handle<T>::value) {
+                if(node.env->reuse_objects) {
+                    PasteNodes(c, node);
+                    return;
+                }
+            }
+
+            auto new_cont = Aux::create_like(c);
             size_t count = 0;
 
-            if(node.parsed) {
+            if(node.is_packed()) {
+                PastePacked(new_cont, node);
+
+            } else if(node.parsed) {
                 for(auto& itm : node.items<E>()) {
                     ElemSwitch<T, E>::Insert(new_cont, itm.field, count++);
                 }
@@ -518,13 +614,103 @@ namespace Srl { namespace Lib {
             c = std::move(new_cont);
         }
 
+        /* refills the existing elements, keeping their allocations */
+        static void PasteInPlace(T& c, Node& node)
+        {
+            if(node.is_packed() && is_packed_container<T>::value) {
+                PastePacked(c, node);
+                return;
+            }
+
+            auto itr       = c.begin();
+            size_t count   = 0;
+            bool appending = false;
+
+            /* appending invalidates itr, so it isn't touched anymore once the old elements are used up */
+            ForEachItem(node, [&](auto& itm) {
+                if(!appending && itr != c.end()) {
+                    Switch<E>::Paste(*itr++, itm, count++);
+                    return;
+                }
+                appending = true;
+                ElemSwitch<T, E>::Insert(c, itm, count++);
+            });
+
+            if(!appending) {
+                c.erase(itr, c.end());
+            }
+        }
+
+        /* moves the nodes of the existing container over to the restored one, keys and values
+         * are restored into the moved nodes, keeping their allocations */
+        static void PasteNodes(T& c, Node& node)
+        {
+            auto new_cont = Aux::create_like(c);
+            size_t count  = 0;
+
+            ForEachItem(node, [&](auto& itm) {
+                if(c.empty()) {
+                    ElemSwitch<T, E>::Insert(new_cont, itm, count++);
+                    return;
+                }
+                auto handle = c.extract(c.begin());
+                ElemSwitch<T, E>::Paste(handle, itm, count++);
+                new_cont.insert(std::move(handle));
+            });
+
+            c = std::move(new_cont);
+        }
+
+        template<class F>
+        static void ForEachItem(Node& node, const F& fnc)
+        {
+            if(node.is_packed()) {
+                if constexpr(!TpTools::is_scope(Switch<E>::type)) {
+                    for(size_t i = 0, n = node.num_values(); i < n; i++) {
+                        auto itm = node.element(i);
+                        fnc(itm);
+                    }
+                }
+
+            } else if(node.parsed) {
+                for(auto& itm : node.items<E>()) {
+                    fnc(itm.field);
+                }
+
+            } else {
+                while(true) {
+                    auto itm = node.consume_item<E>();
+                    if(node.parsed) {
+                        break;
+                    }
+                    fnc(itm);
+                    Finish(itm);
+                }
+            }
+        }
+
+        static void PastePacked(T& c, Node& node)
+        {
+            if constexpr(is_packed_container<T>::value) {
+                c.resize(node.num_values());
+                node.paste_packed(c.data());
+
+            } else if constexpr(!TpTools::is_scope(Switch<E>::type)) {
+                for(size_t i = 0, n = node.num_values(); i < n; i++) {
+                    auto itm = node.element(i);
+                    ElemSwitch<T, E>::Insert(c, itm, i);
+                }
+            }
+            /* packed arrays hold scalars only, there is nothing to paste into scope elements */
+        }
+
         template<class Cont, class Elem, typename = void> struct ElemSwitch {
             static void Extract(const Elem& e, Node& node) {
                 Switch<Elem>::Insert(e, node, Aux::str_empty);
             }
             template<class Item>
             static void Insert(Cont& c, Item& itm, size_t index) {
-                c.emplace_back(Ctor<Elem>::Create());
+                c.emplace_back(Aux::create_using<Elem>(c.get_allocator()));
                 Switch<Elem>::Paste(c.back(), itm, index);
             }
         };
@@ -540,10 +726,15 @@ namespace Srl { namespace Lib {
 
             template<class Item>
             static void Insert(Cont& c, Item& itm, size_t index) {
-                auto elem = Ctor<ElemNC>::Create();
+                auto elem = Aux::create_using<ElemNC>(c.get_allocator());
                 Switch<Elem>::Paste(elem, itm, index);
                 c.insert(c.end(), std::move(elem));
             }
+
+            template<class Handle, class Item>
+            static void Paste(Handle& handle, Item& itm, size_t index) {
+                Switch<ElemNC>::Paste(handle.value(), itm, index);
+            }
         };
 
         /* special care for map-like containers */
@@ -551,19 +742,26 @@ namespace Srl { namespace Lib {
             typedef typename std::remove_const<Key>::type KeyNC;
 
             static void Extract(const std::pair<Key,Value>& p, Node& node) {
+                /* the pair with the const key is stored as it is, without copying it */
                 Switch<std::pair<KeyNC, Value>>::InsertPair(p, node, Aux::str_empty, Aux::str_key, Aux::str_value);
             }
 
             template<class Item>
             static void Insert(Cont& c, Item& itm, size_t) {
-                auto key = Ctor<KeyNC>::Create();
+                auto key = Aux::create_using<KeyNC>(c.get_allocator());
                 itm.paste_field(Aux::str_key, key);
 
-                auto val = Ctor<Value>::Create();
+                auto val = Aux::create_using<Value>(c.get_allocator());
                 itm.paste_field(Aux::str_value, val);
 
                 c.emplace(std::move(key), std::move(val));
             }
+
+            template<class Handle, class Item>
+            static void Paste(Handle& handle, Item& itm, size_t) {
+                itm.paste_field(Aux::str_key, handle.key());
+                itm.paste_field(Aux::str_value, handle.mapped());
+            }
         };
     };
 
@@ -576,6 +774,12 @@ namespace Srl { namespace Lib {
 
         static void Insert(const T& ar, Node& node, const String& name)
         {
+            if constexpr(is_packable<E>::value) {
+                if(node.insert_packed(ar, len, name)) {
+                    return;
+                }
+            }
+
             node.open_scope(&Insert, type, name, ar);
         }
 
@@ -593,7 +797,20 @@ namespace Srl { namespace Lib {
 
             size_t count = 0;
 
-            if(node.parsed) {
+            if(node.is_packed()) {
+
+                Aux::check_size(len, node.num_values(), id);
+
+                if constexpr(is_packable<E>::value) {
+                    node.paste_packed(ar);
+
+                } else if constexpr(!TpTools::is_scope(Switch<E>::type)) {
+                    for(; count < len; count++) {
+                        Switch<E>::Paste(ar[count], node.element(count), count);
+                    }
+                }
+
+            } else if(node.parsed) {
 
                 Aux::check_size(len, node.items<E>().size(), id);
 
@@ -621,14 +838,17 @@ namespace Srl { namespace Lib {
             InsertPair(p, node, name, Aux::str_first, Aux::str_second);
         }
 
-        static void InsertPair(const std::pair<F,S>& p, Node& node, const String& node_name,
-                                const String& first_id, const String& second_id)
+        /* P is either std::pair<F,S> or the std::pair<const F,S> of maps */
+        template<class P>
+        static void InsertPair(const P& p, Node& node, const String& node_name,
+                               const String& first_id, const String& second_id)
         {
-            node.open_scope(&Insert, Type::Object, node_name, p, first_id, second_id);
+            node.open_scope(&InsertFields<P>, Type::Object, node_name, p, first_id, second_id);
         }
 
-        static void Insert(Node& node, const std::pair<F,S>& pair,
-                           const String& first_id, const String& second_id)
+        template<class P>
+        static void InsertFields(Node& node, const P& pair,
+                                 const String& first_id, const String& second_id)
         {
             Switch<F>::Insert(pair.first,  node, first_id);
             Switch<S>::Insert(pair.second, node, second_id);
@@ -735,11 +955,26 @@ namespace Srl { namespace Lib {
         template<class Item, class ID = String>
         static void Paste(T& p, Item& item, const ID& id = Aux::str_empty)
         {
-            E* content = nullptr;
+            if(!p || !Reuse(item)) {
+                E* content = nullptr;
+                Apply(content, item, id);
+                p = T(content);
+                return;
+            }
+
+            /* restore into the current pointee, polymorphic ones are replaced on a type mismatch */
+            E* content = p.get();
             Apply(content, item, id);
-            p = T(content);
+
+            if(content != p.get()) {
+                p.release();
+                p.reset(content);
+            }
         }
 
+        static bool Reuse(const Node& node) { return node.env->reuse_objects; }
+        static bool Reuse(const Value&)     { return false; }
+
         template<class C, class Item, class ID>
         static typename std::enable_if<is_polymorphic<C*>::value, void>::type
         Apply(C*& p, Item& item, const ID& id)
@@ -751,6 +986,11 @@ namespace Srl { namespace Lib {
         static typename std::enable_if<!is_polymorphic<C*>::value, void>::type
         Apply(C*& p, Item& item, const ID& id)
         {
+            if(p != nullptr) {
+                Switch<C>::Paste(*p, item, id);
+                return;
+            }
+
             auto uptr = Ctor<C>::Create_New();
             Switch<C>::Paste(*uptr.get(), item, id);
             p = uptr.release();
@@ -787,9 +1027,7 @@ namespace Srl { namespace Lib {
             bool inserted_new; std::shared_ptr<void>* sptr;
 
             std::tie(inserted_new, sptr) = node.find_shared(key, [&p, &node] {
-                E* e = nullptr;
-                Apply(e, node);
-                p = std::shared_ptr<E>(e);
+                p = Create<E>(node);
                 return p;
             });
 
@@ -799,19 +1037,30 @@ namespace Srl { namespace Lib {
         }
 
         template<class C>
-        static typename std::enable_if<is_polymorphic<C*>::value, void>::type
-        Apply(C*& p, Node& node)
+        static typename std::enable_if<is_polymorphic<C*>::value, std::shared_ptr<C>>::type
+        Create(Node& node)
         {
+            C* p = nullptr;
             node.paste_field(Aux::str_shared_value, p);
+            return std::shared_ptr<C>(p);
         }
 
         template<class C>
-        static typename std::enable_if<!is_polymorphic<C*>::value, void>::type
-        Apply(C*& p, Node& node)
-        {
+        static typename std::enable_if<!is_polymorphic<C*>::value, std::shared_ptr<C>>::type
+        Create(Node& node)
+        {
+            /* pointee and control block come from the memory resource of the restore, if any */
+            if constexpr(std::is_default_constructible<C>::value) {
+                if(node.env->resource) {
+                    auto sptr = std::allocate_shared<C>(std::pmr::polymorphic_allocator<C>(node.env->resource));
+                    node.paste_field(Aux::str_shared_value, *sptr);
+                    return sptr;
+                }
+            }
+
             auto uptr = Ctor<C>::Create_New();
             node.paste_field(Aux::str_shared_value, *uptr.get());
-            p = uptr.release();
+            return std::shared_ptr<C>(uptr.release());
         }
     };
 
@@ -916,15 +1165,32 @@ namespace Srl { namespace Lib {
         }
     };
 
-    template<class V> struct Switch<HTable<std::string, V>> {
+    /* chained and flat tables with string keys, stored as objects */
+    template<class T> struct is_string_table {
+        static const bool value = false;
+    };
+
+    template<class V> struct is_string_table<HTable<std::string, V>> {
+        static const bool value = true;
+        typedef V mapped_type;
+    };
+
+    template<class V> struct is_string_table<FlatTable<std::string, V>> {
+        static const bool value = true;
+        typedef V mapped_type;
+    };
+
+    template<class T> struct Switch<T, typename std::enable_if<is_string_table<T>::value>::type> {
+        typedef typename is_string_table<T>::mapped_type V;
+
         static const Type type = Type::Object;
 
-        static void Insert(const HTable<std::string, V>& ht, Node& node, const String& name)
+        static void Insert(const T& ht, Node& node, const String& name)
         {
             node.open_scope(&Insert, type, name, ht);
         }
 
-        static void Insert(Node& node, const HTable<std::string, V>& ht)
+        static void Insert(Node& node, const T& ht)
         {
             ht.foreach([&](const std::string& key, const V& value)
             {
@@ -933,7 +1199,7 @@ namespace Srl { namespace Lib {
         }
 
         template<class ID = String>
-        static void Paste(HTable<std::string, V>& ht, Node& node, const ID& id = Aux::str_empty)
+        static void Paste(T& ht, Node& node, const ID& id = Aux::str_empty)
         {
             Aux::check_type(Type::Object, node.type(), id);
 
@@ -1079,6 +1345,48 @@ namespace Srl { namespace Lib {
                 Switch<T>::Insert(*p, node, id);
             }
         }
+
+        /* allocator-aware types get the allocator of their container */
+        template<class T, class Alloc>
+        T create_using(const Alloc& alloc)
+        {
+            if constexpr(!std::uses_allocator<T, Alloc>::value) {
+                return Ctor<T>::Create();
+
+            } else if constexpr(std::is_constructible<T, std::allocator_arg_t, const Alloc&>::value) {
+                return T(std::allocator_arg, alloc);
+
+            } else {
+                return T(alloc);
+            }
+        }
+
+        template<class T>
+        void adopt_resource(T& o, std::pmr::memory_resource* resource)
+        {
+            if constexpr(has_resource_allocator<T>::value) {
+                typedef typename T::allocator_type Alloc;
+
+                if(resource && o.get_allocator() != Alloc(resource)) {
+                    /* allocators of std::pmr types don't propagate on assignment, the object is
+                     * constructed anew, moving doesn't throw */
+                    auto adopted = create_using<T>(Alloc(resource));
+                    o.~T();
+                    new (&o) T(std::move(adopted));
+                }
+            }
+        }
+
+        template<class T>
+        T create_like(const T& container)
+        {
+            if constexpr(has_allocator<T>::value) {
+                return T(container.get_allocator());
+
+            } else {
+                return Ctor<T>::Create();
+            }
+        }
 } } }
 
 #endif
@@ -7,6 +7,7 @@
 #include "PJson.h"
 #include "PMsgPack.h"
 #include "Registration.h"
+#include "Streams.h"
 
 #include "Tree.hpp"
 #include "Node.hpp"
@@ -17,5 +18,7 @@
 #include "Tools.hpp"
 #include "Hash.hpp"
 #include "Union.hpp"
+#include "Fields.hpp"
+#include "Batch.hpp"
 
 #endif
@@ -0,0 +1,83 @@
+#ifndef SRL_STATS_H
+#define SRL_STATS_H
+
+#include <chrono>
+#include <cstdint>
+
+/* Counters are compiled in with SRL_INSTRUMENT, timing spans additionally with SRL_INSTRUMENT_SPANS.
+ * Library and user code have to be compiled with the same setting. Without them all counters stay zero. */
+#if defined(SRL_INSTRUMENT_SPANS) && !defined(SRL_INSTRUMENT)
+    #define SRL_INSTRUMENT
+#endif
+
+namespace Srl {
+
+    /* per thread */
+    struct Stats {
+        uint64_t parser_reads        = 0;
+        uint64_t parser_writes       = 0;
+        /* fields looked up by name */
+        uint64_t field_lookups       = 0;
+        /* fields stored in their node while looking for another one */
+        uint64_t fields_buffered     = 0;
+        uint64_t string_hits         = 0;
+        uint64_t string_misses       = 0;
+        /* names found among the ones interned process wide */
+        uint64_t string_interned     = 0;
+        uint64_t charset_conversions = 0;
+        uint64_t heap_segments       = 0;
+        uint64_t heap_bytes          = 0;
+        uint64_t table_rehashes      = 0;
+        uint64_t table_lookups       = 0;
+        /* entries compared during table lookups */
+        uint64_t table_probes        = 0;
+
+        /* nanoseconds */
+        uint64_t load_ns             = 0;
+        uint64_t store_ns            = 0;
+        uint64_t parse_ns            = 0;
+        uint64_t write_ns            = 0;
+        uint64_t charset_ns          = 0;
+    };
+
+    /* counters of the calling thread, reset clears them after the snapshot is taken */
+    Stats stats (bool reset = false);
+
+    namespace Lib {
+
+        extern thread_local Stats thread_stats;
+
+        class Span {
+
+        public:
+            Span(uint64_t& target_)
+                : target(target_), start(std::chrono::steady_clock::now()) { }
+
+            ~Span()
+            {
+                auto end = std::chrono::steady_clock::now();
+                this->target += std::chrono::duration_cast<std::chrono::nanoseconds>(end - this->start).count();
+            }
+
+        private:
+            uint64_t& target;
+            std::chrono::steady_clock::time_point start;
+        };
+    }
+}
+
+#ifdef SRL_INSTRUMENT
+    #define SRL_COUNT(counter, n) (Srl::Lib::thread_stats.counter += (n))
+#else
+    #define SRL_COUNT(counter, n) ((void)0)
+#endif
+
+#ifdef SRL_INSTRUMENT_SPANS
+    #define SRL_SPAN_CAT(a, b) a##b
+    #define SRL_SPAN_VAR(line) SRL_SPAN_CAT(srl_span_, line)
+    #define SRL_SPAN(span) Srl::Lib::Span SRL_SPAN_VAR(__LINE__) (Srl::Lib::thread_stats.span)
+#else
+    #define SRL_SPAN(span) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef SRL_STREAMS_H
+#define SRL_STREAMS_H
+
+#include <condition_variable>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace Srl {
+
+    namespace Lib {
+
+        static const size_t Stream_Chunk_Size = 1 << 18;
+
+        /* Two buffers of chunk_size bytes. While the caller works on the front buffer a helper thread
+         * transfers the back buffer from or to the underlying stream or file descriptor. */
+        class DoubleBuffer : public std::streambuf {
+
+        protected:
+            enum class Slot : uint8_t { Empty, Full, Done };
+
+            DoubleBuffer(size_t chunk_size)
+                : buffers { std::vector<char>(chunk_size), std::vector<char>(chunk_size) } { }
+
+            std::vector<char> buffers[2];
+            size_t  filled = 0;
+            uint8_t back   = 1;
+            Slot    slot   = Slot::Empty;
+            bool    stop   = false;
+            bool    failed = false;
+
+            std::mutex              lock;
+            std::condition_variable cond;
+            std::thread             helper;
+
+            void join ();
+        };
+
+        class PrefetchBuf : public DoubleBuffer {
+
+        public:
+            PrefetchBuf(std::istream& stream_, size_t chunk_size);
+            PrefetchBuf(int fd_, size_t chunk_size);
+            ~PrefetchBuf() { this->join(); }
+
+        protected:
+            int_type underflow () override;
+
+        private:
+            std::istream* stream = nullptr;
+            int           fd     = -1;
+
+            size_t fetch (char* dst, size_t nbytes);
+            void   work  ();
+        };
+
+        class WriteBehindBuf : public DoubleBuffer {
+
+        public:
+            WriteBehindBuf(std::ostream& stream_, size_t chunk_size);
+            WriteBehindBuf(int fd_, size_t chunk_size);
+            ~WriteBehindBuf();
+
+        protected:
+            int_type overflow (int_type c) override;
+            int      sync     () override;
+
+        private:
+            std::ostream* stream = nullptr;
+            int           fd     = -1;
+
+            bool drain     (const char* src, size_t nbytes);
+            bool hand_over (std::unique_lock<std::mutex>& guard);
+            void work      ();
+        };
+    }
+
+    /* Input stream reading the next chunk of stream or fd on a helper thread while the current one is parsed.
+     * The underlying source is read ahead by up to two chunks. Memory sources don't need this. */
+    class PrefetchStream : public std::istream {
+
+    public:
+        PrefetchStream(std::istream& stream, size_t chunk_size = Lib::Stream_Chunk_Size)
+            : std::istream(nullptr), buffer(stream, chunk_size) { this->rdbuf(&this->buffer); }
+
+        PrefetchStream(int fd, size_t chunk_size = Lib::Stream_Chunk_Size)
+            : std::istream(nullptr), buffer(fd, chunk_size) { this->rdbuf(&this->buffer); }
+
+    private:
+        Lib::PrefetchBuf buffer;
+    };
+
+    /* Output stream writing the previous chunk to stream or fd on a helper thread while the next one is filled.
+     * flush() returns once everything is written, which Tree::store does at the end of each document. */
+    class WriteBehindStream : public std::ostream {
+
+    public:
+        WriteBehindStream(std::ostream& stream, size_t chunk_size = Lib::Stream_Chunk_Size)
+            : std::ostream(nullptr), buffer(stream, chunk_size) { this->rdbuf(&this->buffer); }
+
+        WriteBehindStream(int fd, size_t chunk_size = Lib::Stream_Chunk_Size)
+            : std::ostream(nullptr), buffer(fd, chunk_size) { this->rdbuf(&this->buffer); }
+
+    private:
+        Lib::WriteBehindBuf buffer;
+    };
+}
+
+#endif
@@ -7,16 +7,19 @@
 #include "Value.h"
 #include "Type.h"
 #include "Hash.h"
+#include "Fields.h"
 
 namespace Srl {
 
     namespace Lib {
         struct Environment;
+        class  InternedNames;
     }
 
     class String {
 
         friend struct Lib::Environment;
+        friend class  Lib::InternedNames;
 
 
     public:
@@ -34,6 +37,9 @@ namespace Srl {
         String(const uint8_t* ptr, size_t size_, Encoding encoding_)
             : block({ ptr, size_ }, Type::String, encoding_) { }
 
+        String(const Key& key)
+            : block({ key.data(), key.size() }, Type::String, Encoding::UTF8) { }
+
         template<class TChar = char>
         std::basic_string<TChar> unwrap(bool throw_error = true) const;
 
@@ -50,7 +56,7 @@ namespace Srl {
     namespace Lib {
 
         template<> struct HashSrl<String> {
-            uint64_t operator() (const String& s) const { return Aux::hash_fnc(s.data(), s.size()); }
+            uint64_t operator() (const String& s) const { return Aux::hash_seeded(s.data(), s.size()); }
         };
     }
 
@@ -18,6 +18,8 @@ namespace Tools {
     std::pair<bool, Value> str_to_type (const String& str_wrap, Type hint = Type::Null);
     std::pair<bool, Value> str_to_type (const uint8_t* str, size_t str_len, Type hint = Type::Null);
 
+    Value                bytes_to_type (const uint8_t* bytes, Type type);
+
     std::vector<uint8_t> bytes_to_hex (const uint8_t* bytes, size_t nbytes);
     std::vector<uint8_t> hex_to_bytes (const uint8_t* str, size_t str_len);
     void                 hex_to_bytes (uint8_t* dest, size_t dest_size, const uint8_t* str, size_t str_len);
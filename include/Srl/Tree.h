@@ -4,6 +4,7 @@
 #include "Environment.h"
 #include "Out.h"
 #include "Union.h"
+#include "Batch.h"
 
 #include <memory>
 
@@ -11,6 +12,39 @@ namespace Srl {
 
     class Node;
 
+    namespace Lib {
+        /* element of a top level array loaded in parallel, its offset in the source
+         * and the state parser and environment had when reading it */
+        struct Split {
+            size_t offset;
+            size_t mark;
+            size_t type_ids;
+        };
+    }
+
+    /* memory held by a tree, parsers hold theirs on their own */
+    struct MemoryStats {
+        /* nodes, values and copied strings */
+        Lib::Heap::Stats nodes;
+        Lib::TableStats  strings;
+        /* shared pointers while storing and restoring */
+        Lib::TableStats  shared_store;
+        Lib::TableStats  shared_restore;
+        /* type ids interned by binary formats */
+        Lib::TableStats  type_ids_out;
+        Lib::Heap::Stats type_ids_in;
+        /* output waiting to be flushed to streams */
+        Lib::Heap::Stats output;
+        /* environments of elements loaded in parallel */
+        Lib::Heap::Stats parts;
+        /* capacity of conversion buffers */
+        size_t           buffers = 0;
+
+        size_t reserved   () const;
+        size_t used       () const;
+        size_t fragmented () const;
+    };
+
     class Tree {
 
     friend class Node;
@@ -27,7 +61,19 @@ namespace Srl {
         Union                get(const String& field_name);
         std::optional<Union> try_get(const String& field_name);
 
-        void clear();
+        /* Memory of the tree is kept for reuse, up to keep_bytes of it when given. Reusing a cleared
+         * tree allocates nothing until it outgrows what was kept. */
+        void clear(size_t keep_bytes = Lib::Heap::Keep_All);
+
+        /* restored objects keep their containers, strings and pointees, only the content is replaced */
+        Tree& reuse_objects(bool reuse = true);
+
+        /* For very large trees, memory is taken from one reserved range of address space of reserve_bytes,
+         * committed as the tree grows and backed by transparent huge pages where available. See Heap::reserve. */
+        Tree& reserve_memory(size_t reserve_bytes, bool huge_pages = true);
+
+        /* walks all heaps and tables of the tree, meant for budgets and tuning, not for hot paths */
+        MemoryStats memory_stats() const;
 
         template<class T>
         void load_object(const T& type);
@@ -41,6 +87,10 @@ namespace Srl {
         template<class TParser>
         void load_source (const char* data, size_t data_len,TParser&& parser = TParser());
 
+        /* top level arrays of objects or arrays are read on n_threads threads, 0 uses all cores */
+        template<class TParser>
+        void load_source_parallel (Lib::In::Source source, TParser&& parser = TParser(), size_t n_threads = 0);
+
         template<class TParser>
         std::vector<uint8_t> to_source (TParser&& parser = TParser());
 
@@ -65,6 +115,13 @@ namespace Srl {
         template<class Object, class TParser>
         Object restore(const uint8_t* data, size_t len, TParser&& parser = TParser());
 
+        /* objects are constructed with allocators drawing from resource where they are allocator-aware */
+        template<class TParser, class Object>
+        void restore(Object& object, Lib::In::Source source, std::pmr::memory_resource* resource, TParser&& parser = TParser());
+
+        template<class Object, class TParser>
+        Object restore(Lib::In::Source source, std::pmr::memory_resource* resource, TParser&& parser = TParser());
+
         template<class TParser, class... Items>
         void pack(Lib::Out::Source out, TParser&& parser, const Items&... items);
 
@@ -73,6 +130,8 @@ namespace Srl {
 
     private:
         std::unique_ptr<Lib::Environment> env;
+        /* environments of elements loaded in parallel */
+        std::vector<std::unique_ptr<Lib::Environment>> parts;
 
         Node* root_node = nullptr;
 
@@ -82,11 +141,23 @@ namespace Srl {
         void read_source (Parser& parser, Lib::In::Source source, const std::function<void()>& restore_switch);
 
         void prologue_in(Parser& parser, Lib::In::Source& source);
+
+        std::vector<Lib::Split> scan_array (Parser& parser, const Lib::MemBlock& source);
+        void resume_source   (Parser& parser, const Lib::MemBlock& source, const Tree& scanner,
+                              const std::vector<Lib::Split>& splits, size_t first, size_t last);
+        void load_element    ();
+        /* false if the element holds shared pointers */
+        bool restore_element (const std::function<void()>& restore_switch);
+        void rebind          (Tree& target);
+        void stitch          (Tree& part);
         void create_env(Srl::Type root_node_tp = Srl::Type::Object);
         Lib::Environment& get_env();
 
         template<class Object>
         friend void Restore(Object& object, Lib::In::Source source, Parser& parser);
+
+        template<class Object, class TParser>
+        friend std::vector<Object> restore_parallel(Lib::In::Source source, size_t n_threads);
     };
 }
 
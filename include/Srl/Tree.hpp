@@ -74,8 +74,17 @@ namespace Srl {
         this->prologue_in(parser, in);
 
         this->root_node->parsed = false;
+        this->env->borrow_source = true;
 
-        this->root_node->paste(items...);
+        try {
+            this->root_node->paste(items...);
+
+        } catch(...) {
+            this->env->release_source(*this->root_node);
+            throw;
+        }
+
+        this->env->release_source(*this->root_node);
     }
 
     template<class TParser>
@@ -102,6 +111,43 @@ namespace Srl {
         this->read_source(parser, source);
     }
 
+    template<class TParser>
+    void Tree::load_source_parallel(Lib::In::Source source, TParser&& parser, size_t n_threads)
+    {
+        if(source.is_stream || !parser.resumes()) {
+            this->read_source(parser, source);
+            return;
+        }
+
+        auto splits = this->scan_array(parser, source.block);
+        auto count  = splits.size() - 1;
+
+        n_threads = Lib::batch_threads(n_threads, count);
+        auto n_chunks = Lib::batch_chunks(n_threads, count);
+
+        typedef typename std::decay<TParser>::type TP;
+
+        std::vector<Tree>   chunks(n_chunks);
+        std::vector<TP>     parsers(n_threads);
+
+        Lib::parallel_for(n_chunks, n_threads, [&](size_t worker, size_t chunk) {
+            auto first = count * chunk / n_chunks;
+            auto last  = count * (chunk + 1) / n_chunks;
+
+            chunks[chunk].resume_source(parsers[worker], source.block, *this, splits, first, last);
+
+            for(auto i = first; i < last; i++) {
+                chunks[chunk].load_element();
+            }
+            /* from now on the elements belong to this tree */
+            chunks[chunk].rebind(*this);
+        });
+
+        for(auto& chunk : chunks) {
+            this->stitch(chunk);
+        }
+    }
+
     template<class TParser>
     void Tree::load_source(const char* data, size_t data_len,  TParser&& parser)
     {
@@ -157,6 +203,32 @@ namespace Srl {
         return this->restore<Object>(Lib::In::Source(data, len), parser);
     }
 
+    template<class TParser, class Object>
+    void Tree::restore(Object& object, Lib::In::Source source, std::pmr::memory_resource* resource, TParser&& parser)
+    {
+        auto& environment = this->get_env();
+        environment.resource = resource;
+
+        try {
+            this->restore(object, source, parser);
+
+        } catch(...) {
+            environment.resource = nullptr;
+            throw;
+        }
+
+        environment.resource = nullptr;
+    }
+
+    template<class Object, class TParser>
+    Object Tree::restore(Lib::In::Source source, std::pmr::memory_resource* resource, TParser&& parser)
+    {
+        auto object = Lib::Aux::create_using<Object>(std::pmr::polymorphic_allocator<std::byte>(resource));
+        this->restore(object, source, resource, parser);
+
+        return object;
+    }
+
     template<class T>
     void Tree::load_object(const T& type)
     {
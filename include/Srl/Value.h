@@ -33,15 +33,30 @@ namespace Srl {
         Value(const Lib::MemBlock& data_, Type type_, Encoding encoding_)
             : block(data_, type_, encoding_) { }
 
+        /* array of scalars of type elem_type_ packed into a single block */
+        Value(const Lib::MemBlock& data_, Type type_, Type elem_type_)
+            : block(data_, type_, Encoding::Unknown) { this->block.elem_type = elem_type_; }
+
+        /* data_ borrowed from the source, valid as long as the source is */
+        Value(const Lib::MemBlock& data_, Type type_, Encoding encoding_, bool borrowed_)
+            : block(data_, type_, encoding_) { this->block.borrowed = borrowed_; }
+
+        /* Marks the type id of a polymorphic object. Parsers which intern type ids write the n-th distinct id
+         * of a document as n after its first occurrence and mark the ids they read, other fields are left alone. */
+        inline Value& as_type_id();
+
         template<class T> T    unwrap() const;
         template<class T> void paste(T& o) const;
 
-        inline Type                    type()     const;
-        inline Encoding                encoding() const;
-        inline size_t                  size()     const;
-        inline const uint8_t*          data()     const;
-        inline const String&           name()     const;
-        inline const Lib::PackedBlock& pblock()   const;
+        inline Type                    type()      const;
+        inline Encoding                encoding()  const;
+        inline Type                    elem_type() const;
+        inline size_t                  size()      const;
+        inline bool                    borrowed()  const;
+        inline bool                    is_type_id() const;
+        inline const uint8_t*          data()      const;
+        inline const String&           name()      const;
+        inline const Lib::PackedBlock& pblock()    const;
 
     private:
         Value(const Lib::PackedBlock& data_) : block(data_) { }
@@ -80,6 +80,27 @@ namespace Srl {
         return this->block.encoding;
     }
 
+    inline Type Value::elem_type() const
+    {
+        return this->block.elem_type;
+    }
+
+    inline bool Value::borrowed() const
+    {
+        return this->block.borrowed;
+    }
+
+    inline bool Value::is_type_id() const
+    {
+        return this->block.type_id;
+    }
+
+    inline Value& Value::as_type_id()
+    {
+        this->block.type_id = true;
+        return *this;
+    }
+
     inline const String& Value::name() const
     {
         return this->name_ptr
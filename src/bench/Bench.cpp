@@ -0,0 +1,198 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace Bench;
+
+Bench::Options Bench::options;
+
+namespace {
+
+    /* the bench runs single threaded, no need for an atomic counter */
+    size_t n_allocations = 0;
+
+    struct Result {
+        string dataset;
+        string parser;
+        string mode;
+        size_t nbytes;
+        double median_us;
+        double p99_us;
+        double mb_per_s;
+        double allocs;
+    };
+
+    bool first_result = true;
+
+    void print_header()
+    {
+        switch(options.output) {
+            case Output::Table :
+                printf("%-12s %-9s %-8s %12s %12s %12s %10s %12s\n",
+                       "dataset", "parser", "mode", "bytes", "median us", "p99 us", "MB/s", "allocs/op");
+                break;
+            case Output::Csv :
+                printf("dataset,parser,mode,bytes,median_us,p99_us,mb_per_s,allocs_per_op\n");
+                break;
+            case Output::Json :
+                printf("[\n");
+                break;
+        }
+    }
+
+    void print_footer()
+    {
+        if(options.output == Output::Json) {
+            printf("\n]\n");
+        }
+    }
+
+    void print_result(const Result& r)
+    {
+        switch(options.output) {
+            case Output::Table :
+                printf("%-12s %-9s %-8s %12zu %12.1f %12.1f %10.1f %12.1f\n",
+                       r.dataset.c_str(), r.parser.c_str(), r.mode.c_str(), r.nbytes,
+                       r.median_us, r.p99_us, r.mb_per_s, r.allocs);
+                break;
+            case Output::Csv :
+                printf("%s,%s,%s,%zu,%.3f,%.3f,%.3f,%.1f\n",
+                       r.dataset.c_str(), r.parser.c_str(), r.mode.c_str(), r.nbytes,
+                       r.median_us, r.p99_us, r.mb_per_s, r.allocs);
+                break;
+            case Output::Json :
+                printf("%s  { \"dataset\": \"%s\", \"parser\": \"%s\", \"mode\": \"%s\", \"bytes\": %zu, "
+                       "\"median_us\": %.3f, \"p99_us\": %.3f, \"mb_per_s\": %.3f, \"allocs_per_op\": %.1f }",
+                       first_result ? "" : ",\n", r.dataset.c_str(), r.parser.c_str(), r.mode.c_str(), r.nbytes,
+                       r.median_us, r.p99_us, r.mb_per_s, r.allocs);
+                break;
+        }
+        first_result = false;
+        fflush(stdout);
+    }
+
+    /* nearest rank */
+    double percentile(const vector<double>& sorted, double p)
+    {
+        auto rank = (size_t)(p * sorted.size() + 0.999999);
+        return sorted[min(max<size_t>(rank, 1), sorted.size()) - 1];
+    }
+
+    size_t parse_arg(const char* arg)
+    {
+        istringstream is(string(arg + 3));
+        size_t in = 0;
+        is >> in;
+
+        return in;
+    }
+}
+
+void* operator new(size_t size)
+{
+    n_allocations++;
+    if(auto* mem = malloc(size ? size : 1)) {
+        return mem;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* mem) noexcept
+{
+    free(mem);
+}
+
+void operator delete(void* mem, size_t) noexcept
+{
+    free(mem);
+}
+
+void Bench::measure(const string& dataset, const string& parser, const string& mode,
+                    size_t nbytes, const function<void()>& fnc)
+{
+    auto name = dataset + "/" + parser + "/" + mode;
+    if(!options.filter.empty() && name.find(options.filter) == string::npos) {
+        return;
+    }
+
+    for(auto i = 0U; i < options.warmups; i++) {
+        fnc();
+    }
+
+    vector<double> times;
+    times.reserve(options.repetitions);
+
+    auto allocs_before = n_allocations;
+
+    for(auto i = 0U; i < options.repetitions; i++) {
+        auto start = chrono::steady_clock::now();
+        fnc();
+        auto end = chrono::steady_clock::now();
+
+        times.push_back(chrono::duration<double, micro>(end - start).count());
+    }
+
+    /* the reserved times vector doesn't allocate */
+    auto allocs = (double)(n_allocations - allocs_before) / options.repetitions;
+
+    sort(times.begin(), times.end());
+    auto median = percentile(times, 0.5);
+
+    print_result({ dataset, parser, mode, nbytes, median, percentile(times, 0.99),
+                   median > 0 ? nbytes / median : 0, allocs });
+}
+
+int main(int argc, char** args)
+{
+    for(int i = 1; i < argc; i++) {
+        string arg(args[i]);
+
+        if(arg.compare(0, 3, "-w=") == 0) {
+            options.warmups = parse_arg(args[i]);
+
+        } else if(arg.compare(0, 3, "-r=") == 0) {
+            options.repetitions = max<size_t>(1, parse_arg(args[i]));
+
+        } else if(arg.compare(0, 3, "-s=") == 0) {
+            options.scale = max<size_t>(1, parse_arg(args[i]));
+
+        } else if(arg.compare(0, 3, "-d=") == 0) {
+            options.filter = arg.substr(3);
+
+        } else if(arg == "-f=csv") {
+            options.output = Output::Csv;
+
+        } else if(arg == "-f=json") {
+            options.output = Output::Json;
+
+        } else {
+            cerr << "usage: " << args[0] << " [-w=warmups] [-r=repetitions] [-s=scale] "
+                 << "[-d=dataset/parser/mode filter] [-f=csv|json]" << endl;
+            return -1;
+        }
+    }
+
+    print_header();
+
+    try {
+        run_datasets();
+        run_tables();
+
+    } catch(Srl::Exception& ex) {
+        print_footer();
+        cerr << ex.what() << endl;
+        return -1;
+    }
+
+    print_footer();
+
+    return 0;
+}
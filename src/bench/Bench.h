@@ -0,0 +1,34 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "Srl/Srl.h"
+
+#include <functional>
+#include <string>
+
+namespace Bench {
+
+    enum class Output { Table, Csv, Json };
+
+    struct Options {
+        size_t      warmups     = 3;
+        size_t      repetitions = 15;
+        size_t      scale       = 1;
+        std::string filter;
+        Output      output      = Output::Table;
+    };
+
+    extern Options options;
+
+    /* Runs fnc options.warmups times untimed and options.repetitions times timed.
+     * nbytes is the document size the throughput is computed from. */
+    void measure (const std::string& dataset, const std::string& parser, const std::string& mode,
+                  size_t nbytes, const std::function<void()>& fnc);
+
+    void run_datasets ();
+
+    /* inserts, hits and misses of the hash tables */
+    void run_tables ();
+}
+
+#endif
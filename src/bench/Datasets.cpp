@@ -0,0 +1,249 @@
+#include "Bench.h"
+
+#include <map>
+#include <memory>
+
+using namespace std;
+using namespace Srl;
+using namespace Bench;
+
+namespace {
+
+    /* binary tree of objects */
+    struct Nested {
+        int            level = 0;
+        string         tag;
+        vector<Nested> children;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("level", level) ("tag", tag) ("children", children);
+        }
+    };
+
+    Nested make_nested(int depth)
+    {
+        Nested nested;
+        nested.level = depth;
+        nested.tag   = "level" + to_string(depth);
+
+        if(depth > 0) {
+            nested.children = { make_nested(depth - 1), make_nested(depth - 1) };
+        }
+
+        return nested;
+    }
+
+    /* many short fields of mixed types */
+    struct Wide {
+        int32_t  i0 = 0, i1 = 1, i2 = 2, i3 = 3, i4 = 4, i5 = 5, i6 = 6, i7 = 7;
+        uint64_t u0 = 1ULL << 40, u1 = 1ULL << 50, u2 = 1ULL << 60, u3 = 3;
+        double   d0 = 0.5, d1 = 1.25, d2 = -3.75, d3 = 1e100;
+        bool     b0 = true, b1 = false;
+        string   s0 = "alpha", s1 = "beta", s2 = "gamma", s3 = "delta";
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("i0", i0) ("i1", i1) ("i2", i2) ("i3", i3) ("i4", i4) ("i5", i5) ("i6", i6) ("i7", i7)
+                ("u0", u0) ("u1", u1) ("u2", u2) ("u3", u3)
+                ("d0", d0) ("d1", d1) ("d2", d2) ("d3", d3)
+                ("b0", b0) ("b1", b1)
+                ("s0", s0) ("s1", s1) ("s2", s2) ("s3", s3);
+        }
+    };
+
+    struct Numeric {
+        vector<double>  doubles;
+        vector<int64_t> ints;
+        vector<float>   floats;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("doubles", doubles) ("ints", ints) ("floats", floats);
+        }
+    };
+
+    struct Strings {
+        vector<string>     list;
+        map<string, string> dict;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("list", list) ("dict", dict);
+        }
+    };
+
+    struct Shape {
+        virtual const TypeID& srl_type_id() = 0;
+        virtual void srl_resolve(Context& ctx) = 0;
+        virtual ~Shape() { }
+    };
+
+    struct Circle : Shape {
+        double r = 1.0;
+        const TypeID& srl_type_id() override;
+        void srl_resolve(Context& ctx) override { ctx ("r", r); }
+    };
+
+    struct Rect : Shape {
+        double w = 2.0, h = 3.0;
+        const TypeID& srl_type_id() override;
+        void srl_resolve(Context& ctx) override { ctx ("w", w) ("h", h); }
+    };
+
+    struct Polygon : Shape {
+        vector<double> points { 0, 0, 1, 0, 1, 1 };
+        const TypeID& srl_type_id() override;
+        void srl_resolve(Context& ctx) override { ctx ("points", points); }
+    };
+
+    const auto reg_circle  = register_type<Circle>("Circle");
+    const auto reg_rect    = register_type<Rect>("Rect");
+    const auto reg_polygon = register_type<Polygon>("Polygon");
+
+    const TypeID& Circle::srl_type_id()  { return reg_circle; }
+    const TypeID& Rect::srl_type_id()    { return reg_rect; }
+    const TypeID& Polygon::srl_type_id() { return reg_polygon; }
+
+    /* acyclic graph, every node referencing up to three earlier ones */
+    struct Vertex {
+        int                       id = 0;
+        vector<shared_ptr<Vertex>> edges;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("id", id) ("edges", edges);
+        }
+    };
+
+    template<class TParser, class T>
+    void bench_parser(const string& dataset, const string& parser_name, T& data)
+    {
+        Tree    tree;
+        TParser parser;
+
+        vector<uint8_t> source;
+        tree.store(data, source, parser);
+        auto nbytes = source.size();
+
+        vector<uint8_t> out;
+        measure(dataset, parser_name, "store", nbytes, [&] {
+            tree.store(data, out, parser);
+        });
+
+        measure(dataset, parser_name, "restore", nbytes, [&] {
+            tree.restore(data, source, parser);
+        });
+
+        Tree loaded;
+        measure(dataset, parser_name, "load", nbytes, [&] {
+            loaded.load_source(source, parser);
+        });
+    }
+
+    template<class T>
+    void bench_dataset(const string& dataset, T&& data)
+    {
+        bench_parser<PSrl>(dataset, "srl", data);
+        bench_parser<PJson>(dataset, "json", data);
+        bench_parser<PMsgPack>(dataset, "msgpack", data);
+    }
+
+    struct Record {
+        int64_t id = 0, x = 0, y = 0;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("id", id) ("x", x) ("y", y);
+        }
+    };
+
+    /* walks all values of a large document, loaded into a tree allocating segments one by one
+     * and into a tree with reserved memory */
+    void bench_traversal(size_t n_records)
+    {
+        vector<Record> records(n_records);
+        for(auto i = 0U; i < n_records; i++) {
+            records[i] = { i, i * 3, i * 7 + 1 };
+        }
+
+        auto source = Tree().store<PSrl>(records);
+
+        const auto traverse = [&](const string& memory, Tree& tree) {
+            tree.load_source(source, PSrl());
+
+            measure("huge_dom", memory, "traverse", source.size(), [&] {
+                int64_t sum = 0;
+                tree.root().foreach_value([&](Value& value) { sum += value.unwrap<int64_t>(); }, true);
+                if(sum == 0) {
+                    throw Exception("Traversal found no values.");
+                }
+            });
+        };
+
+        Tree heap_tree;
+        traverse("heap", heap_tree);
+
+        Tree mapped_tree;
+        mapped_tree.reserve_memory(source.size() * 64);
+        traverse("reserved", mapped_tree);
+    }
+}
+
+void Bench::run_datasets()
+{
+    auto scale = options.scale;
+
+    {
+        vector<Nested> nested;
+        for(auto i = 0U; i < 4 * scale; i++) {
+            nested.push_back(make_nested(12));
+        }
+        bench_dataset("nested", move(nested));
+    }
+
+    bench_dataset("wide", vector<Wide>(2000 * scale));
+
+    {
+        Numeric numeric;
+        for(auto i = 0U; i < 100000 * scale; i++) {
+            numeric.doubles.push_back(i * 1.000731);
+            numeric.ints.push_back((int64_t)i * 2654435761LL - (1LL << 40));
+            numeric.floats.push_back(i * 0.25f);
+        }
+        bench_dataset("numeric", move(numeric));
+    }
+
+    {
+        Strings strings;
+        for(auto i = 0U; i < 20000 * scale; i++) {
+            auto str = string(8 + i % 120, 'a' + i % 26) + to_string(i);
+            strings.list.push_back(str);
+            strings.dict["key" + to_string(i)] = str;
+        }
+        bench_dataset("strings", move(strings));
+    }
+
+    {
+        vector<unique_ptr<Shape>> shapes;
+        for(auto i = 0U; i < 20000 * scale; i++) {
+            shapes.emplace_back(i % 3 == 0 ? (Shape*)new Circle() : i % 3 == 1 ? (Shape*)new Rect() : new Polygon());
+        }
+        bench_dataset("polymorphic", move(shapes));
+    }
+
+    {
+        vector<shared_ptr<Vertex>> graph;
+        for(auto i = 0U; i < 10000 * scale; i++) {
+            auto vertex = make_shared<Vertex>();
+            vertex->id = i;
+            for(auto k = 1U; k <= 3 && k <= i; k++) {
+                vertex->edges.push_back(graph[(i * 7 + k * 13) % i]);
+            }
+            graph.push_back(vertex);
+        }
+        bench_dataset("shared", move(graph));
+    }
+
+    bench_traversal(200000 * scale);
+}
@@ -0,0 +1,140 @@
+#include "Bench.h"
+
+using namespace std;
+using namespace Srl;
+using namespace Bench;
+
+namespace {
+
+    /* keys shaped like field names, looked up the way the string tables of parsers look them up */
+    vector<Lib::MemBlock> make_keys(vector<string>& storage, size_t n, const string& prefix)
+    {
+        storage.clear();
+        for(auto i = 0U; i < n; i++) {
+            storage.push_back(prefix + "_field_" + to_string(i * 2654435761U % 1000003));
+        }
+
+        vector<Lib::MemBlock> keys;
+        for(auto& str : storage) {
+            keys.emplace_back((const uint8_t*)str.data(), str.size());
+        }
+
+        return keys;
+    }
+
+    struct IncrementalTable : Lib::HTable<Lib::MemBlock, size_t> {
+        IncrementalTable() { this->incremental_rehash(); }
+    };
+
+    template<class Table>
+    void bench_table(const string& name, const vector<Lib::MemBlock>& keys, const vector<Lib::MemBlock>& missing)
+    {
+        size_t nbytes = 0;
+        for(auto& key : keys) {
+            nbytes += key.size;
+        }
+
+        measure("table", name, "insert", nbytes, [&] {
+            Table table;
+            for(auto i = 0U; i < keys.size(); i++) {
+                table.insert(keys[i], i);
+            }
+        });
+
+        Table table;
+        for(auto i = 0U; i < keys.size(); i++) {
+            table.insert(keys[i], i);
+        }
+
+        measure("table", name, "hit", nbytes, [&] {
+            size_t sum = 0;
+            for(auto& key : keys) {
+                sum += *table.get(key);
+            }
+            if(sum == 0 && keys.size() > 2) {
+                throw Exception("Table lookups found nothing.");
+            }
+        });
+
+        measure("table", name, "miss", nbytes, [&] {
+            for(auto& key : missing) {
+                if(table.get(key)) {
+                    throw Exception("Table lookup found a missing key.");
+                }
+            }
+        });
+    }
+
+    /* the byte-wise hash used before, as a reference */
+    uint64_t fnv1a(const uint8_t* bytes, size_t nbytes)
+    {
+        uint64_t hash = 0xCBF29CE484222325;
+        for(auto i = 0U; i < nbytes; i++) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3;
+        }
+        return hash;
+    }
+
+    void bench_hash(const string& name, uint64_t (*hash_fnc)(const uint8_t*, size_t))
+    {
+        for(auto len : { 8U, 24U, 64U }) {
+            vector<string> names;
+            for(auto i = 0U; i < 100000 * options.scale; i++) {
+                auto str = "n" + to_string(i * 2654435761U);
+                str.resize(len, '_');
+                names.push_back(str);
+            }
+
+            measure("hash", name, "len" + to_string(len), names.size() * len, [&] {
+                uint64_t acc = 0;
+                for(auto& str : names) {
+                    acc ^= hash_fnc((const uint8_t*)str.data(), str.size());
+                }
+                if(acc == 0) {
+                    throw Exception("Hashes cancelled out.");
+                }
+            });
+        }
+    }
+
+    /* short-lived trees loading documents with the same field names, before and after interning them */
+    void bench_interning()
+    {
+        vector<string> names;
+        string json = "{";
+        for(auto i = 0U; i < 40; i++) {
+            names.push_back("schema_field_name_" + to_string(i));
+            json += (i > 0 ? ",\"" : "\"") + names.back() + "\":" + to_string(i);
+        }
+        json += "}";
+
+        const auto load = [&](const string& name) {
+            measure("intern", name, "load", json.size() * 100, [&] {
+                for(auto i = 0; i < 100; i++) {
+                    Tree().load_source(json, PJson());
+                }
+            });
+        };
+
+        load("copied");
+        intern_names(vector<String>(names.begin(), names.end()));
+        load("interned");
+    }
+}
+
+void Bench::run_tables()
+{
+    vector<string> stored, absent;
+    auto keys    = make_keys(stored, 100000 * options.scale, "stored");
+    auto missing = make_keys(absent, 100000 * options.scale, "absent");
+
+    bench_table<Lib::HTable<Lib::MemBlock, size_t>>("chained", keys, missing);
+    bench_table<IncrementalTable>("gradual", keys, missing);
+    bench_table<Lib::FlatTable<Lib::MemBlock, size_t>>("flat", keys, missing);
+
+    bench_hash("fnv1a", fnv1a);
+    bench_hash("unseeded", Lib::Aux::hash_fnc);
+    bench_hash("seeded", Lib::Aux::hash_seeded);
+
+    bench_interning();
+}
@@ -0,0 +1,154 @@
+#include "Srl/Srl.h"
+#include "Srl/Lib.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+using namespace Srl;
+using namespace Lib;
+
+namespace {
+
+    /* indices [begin, end) left to a worker */
+    struct Share {
+        mutex  lock;
+        size_t begin = 0;
+        size_t end   = 0;
+    };
+
+    bool take(Share& share, size_t& idx)
+    {
+        lock_guard<mutex> guard(share.lock);
+
+        if(share.begin >= share.end) {
+            return false;
+        }
+        idx = share.begin++;
+
+        return true;
+    }
+
+    bool steal(vector<Share>& shares, size_t thief)
+    {
+        auto n_shares = shares.size();
+
+        for(auto i = 1U; i < n_shares; i++) {
+            auto& victim = shares[(thief + i) % n_shares];
+            size_t begin, end;
+            {
+                lock_guard<mutex> guard(victim.lock);
+
+                if(victim.begin >= victim.end) {
+                    continue;
+                }
+                /* the upper half, the victim keeps working on the lower one */
+                end   = victim.end;
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                victim.end = begin;
+            }
+
+            lock_guard<mutex> guard(shares[thief].lock);
+            shares[thief].begin = begin;
+            shares[thief].end   = end;
+
+            return true;
+        }
+
+        return false;
+    }
+}
+
+size_t Lib::batch_threads(size_t n_threads, size_t count)
+{
+    if(n_threads == 0) {
+        n_threads = thread::hardware_concurrency();
+    }
+
+    return max<size_t>(1, min(n_threads, count));
+}
+
+size_t Lib::batch_chunks(size_t n_threads, size_t count)
+{
+    return min(count, n_threads * 8);
+}
+
+void Lib::parallel_for(size_t count, size_t n_threads, const function<void(size_t, size_t)>& fnc)
+{
+    n_threads = batch_threads(n_threads, count);
+
+    vector<Share> shares(n_threads);
+    for(auto i = 0U; i < n_threads; i++) {
+        shares[i].begin = count * i / n_threads;
+        shares[i].end   = count * (i + 1) / n_threads;
+    }
+
+    atomic<bool>  failed { false };
+    exception_ptr error;
+    mutex         error_lock;
+
+    auto work = [&](size_t worker) {
+        try {
+            size_t idx;
+            while(!failed.load(memory_order_relaxed)) {
+                if(take(shares[worker], idx)) {
+                    fnc(worker, idx);
+
+                } else if(!steal(shares, worker)) {
+                    break;
+                }
+            }
+
+        } catch(...) {
+            lock_guard<mutex> guard(error_lock);
+            if(!failed.exchange(true)) {
+                error = current_exception();
+            }
+        }
+    };
+
+    vector<thread> threads;
+    threads.reserve(n_threads - 1);
+
+    for(auto i = 1U; i < n_threads; i++) {
+        threads.emplace_back(work, i);
+    }
+    /* the calling thread is worker 0 */
+    work(0);
+
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    if(error) {
+        rethrow_exception(error);
+    }
+}
+
+vector<MemBlock> Lib::split_frames(const uint8_t* data, size_t size)
+{
+    vector<MemBlock> frames;
+    size_t pos = 0;
+
+    while(pos < size) {
+        uint64_t frame_size = 0;
+
+        if(size - pos < sizeof(frame_size)) {
+            throw Exception("Unable to restore batch. Frame header out of bounds.");
+        }
+        for(auto i = 0U; i < sizeof(frame_size); i++) {
+            frame_size |= (uint64_t)data[pos + i] << (i * 8);
+        }
+        pos += sizeof(frame_size);
+
+        if(frame_size > size - pos) {
+            throw Exception("Unable to restore batch. Frame out of bounds.");
+        }
+        frames.emplace_back(data + pos, frame_size);
+        pos += frame_size;
+    }
+
+    return frames;
+}
@@ -26,10 +26,28 @@ namespace {
     {
         return Aux::hash_fnc(str.data(), str.size());
     }
+
+    bool is_type_index(const Value& value)
+    {
+        return value.is_type_id() && TpTools::is_num(value.type()) && !TpTools::is_fp(value.type());
+    }
+
+    size_t npos = std::numeric_limits<size_t>::max();
+
+    /* copies data not owned by the block into the heap */
+    void own_block(PackedBlock& block, Heap& heap)
+    {
+        block.borrowed = false;
+
+        if(!block.stored_local && !block.try_store_local()) {
+            block.extern_data = Aux::copy(heap, { block.extern_data, block.size }).ptr;
+        }
+    }
 }
 
 
-const String Environment::EmptyString = Srl::String();
+const String   Environment::EmptyString = Srl::String();
+const MemBlock Environment::TypeIdName((const uint8_t*)"srl_type_id", 11);
 const uint64_t EmptyStringHash = hash_fnc(String());
 
 
@@ -56,19 +74,28 @@ pair<const String*, size_t> Environment::store_string(const String& str)
     auto conv = conv_str(str, this->str_buffer, Environment::Str_Encoding);
     auto hash = hash_fnc(conv);
 
-    auto* str_ptr = this->str_table.get(conv);
+    if(auto* interned = interned_names()->find(conv, hash)) {
+        SRL_COUNT(string_interned, 1);
+        return { interned, hash };
+    }
+
+    /* the table's seeded hash, the link hash above is independent of the process */
+    auto table_hash = this->str_table.hash(conv);
+    auto* str_ptr   = this->str_table.get(conv, table_hash);
 
     if(str_ptr) {
+        SRL_COUNT(string_hits, 1);
         return { str_ptr, hash };
     }
 
+    SRL_COUNT(string_misses, 1);
     String new_str(conv);
 
     if(!new_str.block.try_store_local()) {
         new_str.block.extern_data = Aux::copy(this->heap, conv).ptr;
     }
 
-    str_ptr = this->str_table.insert(new_str, new_str).second;
+    str_ptr = this->str_table.insert_hashed(table_hash, new_str, new_str).second;
     return { str_ptr, hash };
 }
 
@@ -85,6 +112,17 @@ Link<T>* Environment::create_link(Lib::Items<T>& lst, const T& val, const String
 
 Link<Node>* Environment::store_node(Node& parent, const Node& node, const String& name)
 {
+    if(node.is_packed()) {
+        Value array = node.packed_value();
+
+        if(this->parsing) {
+            this->write(array, name);
+            return create_node(Type::Array, name);
+        }
+
+        return this->store_array(parent, array, name);
+    }
+
     if(this->parsing) {
 
         Value scope_start = Value(node.scope_type);
@@ -132,65 +170,125 @@ Link<Node>* Environment::create_node(Type type, const String& name)
 
 Link<Value>* Environment::store_value(Node& parent, const Value& value, const String& name)
 {
+    /* the document keeps type ids as strings, whatever the format */
+    if(is_type_index(value)) {
+        auto type_name = this->type_name(value);
+        return this->store_value(parent, Value({ type_name.data(), type_name.size() }, type_name.encoding()).as_type_id(), name);
+    }
+
     auto* link = this->create_link(parent.values, value, name);
     auto& block = link->field.block;
 
-    if(!block.stored_local && !block.try_store_local()) {
-        block.extern_data = Aux::copy(this->heap, { block.extern_data, block.size }).ptr;
+    if(block.borrowed && this->borrow_source) {
+        this->borrowed_kept++;
+        return link;
     }
 
+    own_block(block, this->heap);
+
     return link;
 }
 
-void Environment::write(const Value& value, const String& field_name)
+void Environment::release_source(Node& root)
 {
-    this->write_conv(value, field_name);
+    this->borrow_source = false;
+
+    if(this->borrowed_kept > 0) {
+        this->borrowed_kept = 0;
+        this->own_values(root);
+    }
 }
 
-void Environment::set_input(Parser& parser_, In::Source source)
+void Environment::own_values(Node& node)
 {
-    parser_.clear();
-    this->parser = &parser_;
-    this->in.set(source);
+    for(auto& link : node.values) {
+        if(link.field.block.borrowed) {
+            own_block(link.field.block, this->heap);
+        }
+    }
+    for(auto& link : node.nodes) {
+        this->own_values(link.field);
+    }
 }
 
-void Environment::set_output(Parser& parser_, Lib::Out::Source source)
+Link<Node>* Environment::store_array(Node& parent, const Value& array, const String& name)
 {
-    parser_.clear();
-    this->parser = &parser_;
-    this->out.set(source);
+    auto* link = this->create_link(parent.nodes, Node(this->tree, Type::Array), name);
+
+    link->field.packed      = Aux::copy(this->heap, { array.data(), array.size() });
+    link->field.packed_type = array.elem_type();
+
+    return link;
 }
 
-void Environment::write_conv(const Value& value, const String& val_name)
+pair<MemBlock, Value> Environment::read()
 {
-    MemBlock name_conv;
+    return this->pipeline->read(*this);
+}
 
-    if(val_name.encoding() == Encoding::UTF8) {
-        name_conv = MemBlock(val_name.data(), val_name.size());
+void Environment::read_type_id(const Value& type_id)
+{
+    if(type_id.type() == Type::String) {
+        /* ids are numbered in the order their strings appear in the document */
+        auto block = Aux::copy(this->type_ids_heap, { type_id.data(), type_id.size() });
+        this->type_ids_in.emplace_back(String(block, type_id.encoding()), npos);
 
-    } else {
-        auto& buffer = this->str_buffer;
-        auto size = Tools::conv_charset(Encoding::UTF8, val_name, buffer, true);
-        name_conv = MemBlock(buffer.data(), size);
+    } else if(!is_type_index(type_id) || type_id.unwrap<uint64_t>() >= this->type_ids_in.size()) {
+        throw Exception("Unable to parse source. Invalid type id.");
     }
+}
 
-    auto type = value.type();
+String Environment::type_name(const Value& type_id)
+{
+    if(is_type_index(type_id)) {
+        return this->type_ids_in[type_id.unwrap<uint64_t>()].first;
+    }
 
-    bool no_conversion_needed =
-        /* scope types don't need conversion */
-        TpTools::is_scope(type) || type == Type::Scope_End ||
-        /* strings must be UTF8 in text formats */
-        (type == Type::String && parser->get_format() != Format::Text &&
-         value.encoding() == Encoding::UTF8) ||
-        /* binary types must be converted to string in text formats */
-        (type != Type::String && parser->get_format() == Format::Binary);
+    Aux::check_type(Type::String, type_id.type(), String(TypeIdName));
+    return String(type_id.data(), type_id.size(), type_id.encoding());
+}
 
-    if(no_conversion_needed) {
-        parser->write(value, name_conv, this->out);
+size_t Environment::type_slot(const Value& type_id)
+{
+    if(!is_type_index(type_id)) {
+        return registrations()->slot(this->type_name(type_id));
+    }
 
-    } else {
-        parser->write(this->conv_type(value), name_conv, this->out);
+    auto& entry = this->type_ids_in[type_id.unwrap<uint64_t>()];
+
+    if(entry.second == npos) {
+        entry.second = registrations()->slot(entry.first);
     }
+
+    return entry.second;
+}
+
+void Environment::write(const Value& value, const String& field_name)
+{
+    this->pipeline->write(*this, value, field_name);
+}
+
+void Environment::set_input(Parser& parser_, In::Source source)
+{
+    parser_.clear();
+    this->parser   = &parser_;
+    this->pipeline = &parser_.pipeline();
+    this->in.set(source);
+
+    this->intern_type_ids = parser_.interns_type_ids();
+    this->type_ids_in.clear();
+    this->type_ids_heap.clear();
+}
+
+void Environment::set_output(Parser& parser_, Lib::Out::Source source)
+{
+    parser_.clear();
+    this->parser   = &parser_;
+    this->pipeline = &parser_.pipeline();
+    this->out.set(source);
+
+    this->intern_type_ids = parser_.interns_type_ids();
+    this->type_ids_out.clear();
 }
 
 Value Environment::conv_type(const Value& value)
@@ -217,10 +315,17 @@ Value Environment::conv_type(const Value& value)
     return Value( { buffer.data(), data_size }, value.type());
 }
 
-void Environment::clear()
+void Environment::clear(size_t keep_bytes)
 {
-    this->heap.clear();
+    this->heap.clear(keep_bytes);
+    this->borrowed_kept = 0;
     this->str_table.clear();
     this->shared_table_store.clear();
     this->shared_table_restore.clear();
+    this->type_ids_out.clear();
+}
+
+const Pipeline& Parser::pipeline() const
+{
+    return Pipeline::of<Parser>();
 }
@@ -1,49 +1,36 @@
 #include "Srl/Hash.h"
 
+#include <chrono>
+#include <random>
+
 using namespace Srl;
 using namespace Lib;
 
 namespace {
 
-    const uint64_t fnv1a_prime = 0x100000001B3;
-    const uint64_t fnv1a_base  = 0xCBF29CE484222325;
-
-    template<size_t N> void fnv1a_unfold(const uint8_t* bytes, uint64_t& hash)
-    {
-        hash = (hash ^ *bytes) * fnv1a_prime;
-        fnv1a_unfold<N - 1>(bytes + 1, hash);
-    }
-
-    template<> inline void fnv1a_unfold<0>(const uint8_t*, uint64_t&) { }
-
-    uint64_t fnv1a(const uint8_t* bytes, size_t nbytes)
+    uint64_t make_seed()
     {
-        auto hash = fnv1a_base;
-
-        for(auto unroll = nbytes / 8; unroll > 0;
-            unroll--, bytes += 8) {
-
-            fnv1a_unfold<8>(bytes, hash);
-        }
+        uint64_t seed = std::random_device()();
+        seed = seed << 32 ^ std::random_device()();
+        seed ^= (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+        seed ^= (uint64_t)(uintptr_t)&seed;
 
-        auto rem = nbytes % 8;
-
-        switch(rem) {
-            case 0 : break;
-            case 1 : fnv1a_unfold<1>(bytes, hash); break;
-            case 2 : fnv1a_unfold<2>(bytes, hash); break;
-            case 3 : fnv1a_unfold<3>(bytes, hash); break;
-            case 4 : fnv1a_unfold<4>(bytes, hash); break;
-            case 5 : fnv1a_unfold<5>(bytes, hash); break;
-            case 6 : fnv1a_unfold<6>(bytes, hash); break;
-            case 7 : fnv1a_unfold<7>(bytes, hash); break;
-        }
-
-        return hash;
+        return Aux::Wy::mix(seed, Aux::Wy::P0);
     }
 }
 
 uint64_t Aux::hash_fnc(const uint8_t* bytes, size_t nbytes)
 {
-    return fnv1a(bytes, nbytes);
+    return Wy::hash(bytes, nbytes, 0);
+}
+
+uint64_t Aux::hash_seed()
+{
+    static const uint64_t seed = make_seed();
+    return seed;
+}
+
+uint64_t Aux::hash_seeded(const uint8_t* bytes, size_t nbytes)
+{
+    return Wy::hash(bytes, nbytes, hash_seed());
 }
@@ -1,5 +1,14 @@
 #include "Srl/Heap.h"
 
+#include <algorithm>
+#include <atomic>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define SRL_MAPPED_RANGES
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
 using namespace std;
 using namespace Srl;
 using namespace Lib;
@@ -9,30 +18,231 @@ namespace {
     using SegLink   = Aux::SList<Heap::Segment>::Link;
     using ChainLink = Aux::SList<SegLink>::Link;
 
-    void set_subsegment(Heap::Segment& seg, uint8_t* data, size_t sz)
+    /* transparent huge pages are 2 MB where they exist, ranges are aligned to that */
+    const size_t Huge_Page = 1 << 21;
+
+    size_t page_size()
     {
-        memset(data, 0, sz);
-        seg.data = data;
-        seg.left = sz;
-        seg.size = sz;
-        seg.sub_seg = true;
+#ifdef SRL_MAPPED_RANGES
+        static const size_t size = sysconf(_SC_PAGESIZE);
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+    size_t round_to_pages(size_t sz)
+    {
+        auto page = page_size();
+        return (sz + page - 1) / page * page;
+    }
+
+    /* address space only, nothing is committed */
+    uint8_t* map_range(size_t size)
+    {
+#ifdef SRL_MAPPED_RANGES
+        auto* mem = mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return mem == MAP_FAILED ? nullptr : (uint8_t*)mem;
+#else
+        return nullptr;
+#endif
+    }
+
+    bool commit_pages(uint8_t* mem, size_t size)
+    {
+#ifdef SRL_MAPPED_RANGES
+        return mprotect(mem, size, PROT_READ | PROT_WRITE) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /* pages are given back and come back zeroed when touched again */
+    void discard_pages(uint8_t* mem, size_t size)
+    {
+#ifdef SRL_MAPPED_RANGES
+        madvise(mem, size, MADV_DONTNEED);
+#endif
+    }
+
+    void unmap_range(uint8_t* mem, size_t size)
+    {
+#ifdef SRL_MAPPED_RANGES
+        munmap(mem, size);
+#endif
+    }
+
+    /* Links of released segments with power of two sizes from 512 bytes up to Max_Cap, pooled with
+     * their segment. Every class has a fixed number of slots, a slot is taken and filled with a
+     * single atomic exchange, so there is neither a lock nor a stale list head to compare against. */
+    const size_t Pool_Min_Log      = 9;
+    const size_t Pool_Classes      = 10;
+    const size_t Pool_Global_Slots = 16;
+    const size_t Pool_Local_Slots  = 4;
+
+    std::atomic<bool> pool_enabled { false };
+
+    size_t pool_class(size_t size)
+    {
+        for(auto cls = 0U; cls < Pool_Classes; cls++) {
+            if(size == (size_t)1 << (cls + Pool_Min_Log)) {
+                return cls;
+            }
+        }
+        return Pool_Classes;
+    }
+
+    struct GlobalPool {
+
+        std::atomic<ChainLink*> slots[Pool_Classes][Pool_Global_Slots];
+
+        ~GlobalPool() { this->drain(); }
+
+        bool put(size_t cls, ChainLink* link)
+        {
+            for(auto& slot : this->slots[cls]) {
+                ChainLink* empty = nullptr;
+                if(!slot.load(memory_order_relaxed) &&
+                    slot.compare_exchange_strong(empty, link, memory_order_release, memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        ChainLink* take(size_t cls)
+        {
+            for(auto& slot : this->slots[cls]) {
+                if(slot.load(memory_order_relaxed)) {
+                    if(auto* link = slot.exchange(nullptr, memory_order_acquire)) {
+                        return link;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        void drain()
+        {
+            for(auto& cls : this->slots) {
+                for(auto& slot : cls) {
+                    delete slot.exchange(nullptr, memory_order_acquire);
+                }
+            }
+        }
+    };
+
+    GlobalPool global_pool;
+
+    /* served without atomics, overflows into the global pool */
+    struct LocalPool {
+
+        ChainLink* slots[Pool_Classes][Pool_Local_Slots] = { };
+        size_t     count[Pool_Classes] = { };
+
+        ~LocalPool() { this->drain(); }
+
+        void drain()
+        {
+            for(auto cls = 0U; cls < Pool_Classes; cls++) {
+                while(this->count[cls] > 0) {
+                    auto* link = this->slots[cls][--this->count[cls]];
+                    if(!pool_enabled.load(memory_order_relaxed) || !global_pool.put(cls, link)) {
+                        delete link;
+                    }
+                }
+            }
+        }
+    };
+
+    thread_local LocalPool local_pool;
+
+    /* smallest pooled segment of at least size bytes */
+    ChainLink* pool_take(size_t size)
+    {
+        if(!pool_enabled.load(memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        auto first = pool_class(size);
+
+        for(auto cls = first; cls < Pool_Classes; cls++) {
+            if(local_pool.count[cls] > 0) {
+                return local_pool.slots[cls][--local_pool.count[cls]];
+            }
+        }
+
+        for(auto cls = first; cls < Pool_Classes; cls++) {
+            if(auto* link = global_pool.take(cls)) {
+                return link;
+            }
+        }
+
+        return nullptr;
+    }
+
+    /* false if the link has to be deleted */
+    bool pool_put(ChainLink* link)
+    {
+        if(link->val.val.mapped) {
+            return false;
+        }
+
+        auto cls = pool_class(link->val.val.size);
+
+        if(cls == Pool_Classes || !pool_enabled.load(memory_order_relaxed)) {
+            return false;
+        }
+
+        if(local_pool.count[cls] < Pool_Local_Slots) {
+            local_pool.slots[cls][local_pool.count[cls]++] = link;
+            return true;
+        }
+
+        return global_pool.put(cls, link);
     }
 
     void set_segment(Heap::Segment& seg, size_t sz)
     {
+        SRL_COUNT(heap_segments, 1);
+        SRL_COUNT(heap_bytes, sz);
+
         seg.data = new uint8_t[sz];
         seg.left = sz;
         seg.size = sz;
-        seg.sub_seg = false;
     }
 
+    /* memory isn't zeroed, users of the heap initialize what they take */
     void reset_segment(SegLink& link)
     {
         link.val.left = link.val.size;
-        memset(link.val.data, 0, link.val.size);
         link.next = nullptr;
     }
 
+    size_t floor_log2(size_t n)
+    {
+        size_t log = 0;
+        while(n >>= 1) {
+            log++;
+        }
+        return log;
+    }
+
+    size_t lowest_bit(uint64_t mask)
+    {
+        assert(mask != 0);
+#if defined(__GNUC__)
+        return __builtin_ctzll(mask);
+#else
+        size_t bit = 0;
+        while(!(mask & 1)) {
+            mask >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
     struct Any {
         template<class T>
         bool operator() (const T&) const { return true; }
@@ -76,39 +286,6 @@ void Aux::SList<T>::append(SList<T>::Link* link)
     link->next = nullptr;
 }
 
-template<class T> template<class Pred>
-void Aux::SList<T>::prepend(const Pred& pred, SList<T>::Link* link)
-{
-    if(!this->back) {
-        this->front = link;
-        this->back  = link;
-
-    } else {
-
-        Link* curr = this->front;
-        Link* prev = nullptr;
-
-        while(curr) {
-            if(pred(curr->val)) {
-                link->next = curr;
-                if(prev) {
-                    prev->next = link;
-                } else {
-                    front = link;
-                }
-                return;
-            }
-            prev = curr;
-            curr = curr->next;
-        }
-
-        link->next = nullptr;
-        this->back->next = link;
-        this->back = link;
-
-    }
-}
-
 template<class T>
 void Aux::SList<T>::remove(SList<T>::Link* prev, SList<T>::Link* link)
 {
@@ -153,11 +330,104 @@ Aux::SList<T>::find_rm(const Predicate& pred)
 
 void Heap::put_mem(uint8_t* mem, size_t sz)
 {
+    if(!this->recycle) {
+        this->dropped += sz;
+        return;
+    }
 
-    auto* link = this->chain.get_link();
-    set_subsegment(link->val, mem, sz);
+    /* blocks are kept aligned to and sized in multiples of Granule, anything too small for that is dropped */
+    auto rem    = (size_t)mem % Granule;
+    auto offset = rem ? Granule - rem : 0;
+
+    if(sz < offset + Granule) {
+        this->dropped += sz;
+        return;
+    }
+
+    auto* block = reinterpret_cast<FreeBlock*>(mem + offset);
+    auto  kept  = (sz - offset) / Granule * Granule;
+
+    this->dropped += sz - kept;
+    sz = kept;
 
-    this->chain.free_segs.append(link);
+    if(sz <= Small_Limit) {
+        auto list = sz / Granule - 1;
+        block->next = this->small_free[list];
+        this->small_free[list] = block;
+        this->small_mask |= 1ULL << list;
+        return;
+    }
+
+    auto list = floor_log2(sz);
+    block->next = this->large_free[list];
+    block->size = sz;
+    this->large_free[list] = block;
+    this->large_mask |= 1ULL << list;
+}
+
+uint8_t* Heap::take_free(size_t sz)
+{
+    auto need = sz < Granule ? Granule : (sz + Granule - 1) / Granule * Granule;
+
+    FreeBlock* block = nullptr;
+    size_t     size  = 0;
+
+    /* the smallest list with blocks at least as large as needed */
+    if(need <= Small_Limit) {
+        auto first = need / Granule - 1;
+        auto avail = this->small_mask >> first;
+
+        if(avail) {
+            auto list = first + lowest_bit(avail);
+            block = this->small_free[list];
+            size  = (list + 1) * Granule;
+
+            this->small_free[list] = block->next;
+            if(!block->next) {
+                this->small_mask &= ~(1ULL << list);
+            }
+        }
+    }
+
+    if(!block) {
+        /* blocks of a large list may be smaller than the list's lower bound times two */
+        auto first = need <= Small_Limit ? floor_log2(Small_Limit + 1) : floor_log2(need - 1) + 1;
+        auto avail = first < Large_Lists ? this->large_mask >> first : 0;
+
+        if(!avail) {
+            return nullptr;
+        }
+
+        auto list = first + lowest_bit(avail);
+        block = this->large_free[list];
+        size  = block->size;
+
+        this->large_free[list] = block->next;
+        if(!block->next) {
+            this->large_mask &= ~(1ULL << list);
+        }
+    }
+
+    auto* mem = reinterpret_cast<uint8_t*>(block);
+
+    if(size > need) {
+        this->put_mem(mem + need, size - need);
+    }
+
+    return mem;
+}
+
+void Heap::clear_free()
+{
+    for(auto& list : this->small_free) {
+        list = nullptr;
+    }
+    for(auto& list : this->large_free) {
+        list = nullptr;
+    }
+    this->small_mask = 0;
+    this->large_mask = 0;
+    this->dropped    = 0;
 }
 
 Heap::Segment* Heap::find_free_seg(size_t sz, size_t align)
@@ -187,6 +457,11 @@ Heap::Segment* Heap::alloc(size_t n, size_t align)
 {
     Segment* seg = nullptr;
 
+    /* the current segment ending where the committed part of the range ends grows in place */
+    if(this->range.begin && this->crr_seg && this->extend(n + align)) {
+        return this->crr_seg;
+    }
+
     if(this->crr_seg && crr_seg->left > 0) {
         this->put_mem(crr_seg->pointer(), this->crr_seg->left);
     }
@@ -195,16 +470,34 @@ Heap::Segment* Heap::alloc(size_t n, size_t align)
         return seg;
     }
 
-    this->cap = cap < 1 ? 1 : cap * 2 < Max_Cap ? cap * 2 : Max_Cap;
+    auto max_cap = this->range.begin ? Max_Mapped_Cap : Max_Cap;
 
-    if(n < Max_Cap && this->cap < n) {
-        while(this->cap < n && this->cap < Max_Cap) {
+    this->cap = cap < 1 ? 1 : cap * 2 < max_cap ? cap * 2 : max_cap;
+
+    if(n < max_cap && this->cap < n) {
+        while(this->cap < n && this->cap < max_cap) {
             this->cap *= 2;
         }
     }
 
     auto alloc_sz = this->cap > n ? this->cap : n;
 
+    if(this->range.begin && (seg = this->commit(alloc_sz))) {
+        return seg;
+    }
+
+    if(auto* pooled = pool_take(alloc_sz)) {
+        /* pooled segments may be larger, growth continues from there */
+        this->cap = pooled->val.val.size;
+        this->chain.used_links.append(pooled);
+        reset_segment(pooled->val);
+
+        seg = &pooled->val.val;
+        this->chain.used_segs.append(&pooled->val);
+
+        return seg;
+    }
+
     auto* link = this->chain.get_link();
     seg = &link->val;
     set_segment(*seg, alloc_sz);
@@ -214,31 +507,159 @@ Heap::Segment* Heap::alloc(size_t n, size_t align)
     return seg;
 }
 
-void Heap::clear()
+void Heap::reserve(size_t reserve_bytes, bool huge_pages)
+{
+    if(this->range.mapping) {
+        return;
+    }
+
+    auto size = round_to_pages(reserve_bytes);
+    auto* mapping = map_range(size + Huge_Page);
+
+    if(!mapping) {
+        return;
+    }
+
+    auto* begin = mapping + (Huge_Page - (size_t)mapping % Huge_Page) % Huge_Page;
+
+#if defined(SRL_MAPPED_RANGES) && defined(MADV_HUGEPAGE)
+    if(huge_pages) {
+        madvise(begin, size, MADV_HUGEPAGE);
+    }
+#else
+    (void)huge_pages;
+#endif
+
+    this->range.begin   = begin;
+    this->range.size    = size;
+    this->range.mapping = mapping;
+    this->range.mapped  = size + Huge_Page;
+}
+
+Heap::Segment* Heap::commit(size_t sz)
+{
+    sz = round_to_pages(sz);
+
+    auto* mem = this->range.begin + this->range.committed;
+
+    if(sz > UINT32_MAX || this->range.committed + sz > this->range.size || !commit_pages(mem, sz)) {
+        return nullptr;
+    }
+
+    SRL_COUNT(heap_segments, 1);
+    SRL_COUNT(heap_bytes, sz);
+
+    this->range.committed += sz;
+
+    auto* link = this->chain.get_link();
+    link->val.data   = mem;
+    link->val.left   = sz;
+    link->val.size   = sz;
+    link->val.mapped = true;
+
+    this->chain.used_segs.append(link);
+
+    return &link->val;
+}
+
+bool Heap::extend(size_t sz)
+{
+    auto& seg = *this->crr_seg;
+    auto* end = this->range.begin + this->range.committed;
+
+    if(!seg.mapped || seg.data + seg.size != end) {
+        return false;
+    }
+
+    /* doubling the segment, commits stay rare */
+    size_t grow_by = seg.size < Max_Mapped_Cap ? seg.size : Max_Mapped_Cap;
+    sz = round_to_pages(sz > grow_by ? sz : grow_by);
+
+    if((size_t)seg.size + sz > UINT32_MAX || this->range.committed + sz > this->range.size || !commit_pages(end, sz)) {
+        return false;
+    }
+
+    SRL_COUNT(heap_bytes, sz);
+
+    this->range.committed += sz;
+    seg.size += sz;
+    seg.left += sz;
+
+    return true;
+}
+
+void Heap::clear(size_t keep_bytes)
 {
     this->chain.used_segs.clear();
     this->chain.free_segs.clear();
+    this->clear_free();
 
+    if(keep_bytes != Keep_All) {
+        this->trim(keep_bytes);
+    }
+
+    /* segments are allocated with growing sizes, so in link order they are mostly ascending and
+     * finding a free one first fit picks about the smallest fitting one */
     ChainLink* link = this->chain.used_links.front;
-    ChainLink* prev = nullptr;
 
     while(link) {
-        auto* next = link->next;
+        reset_segment(link->val);
+        this->chain.free_segs.append(&link->val);
+        link = link->next;
+    }
+
+    this->crr_seg = nullptr;
+}
 
-        if(link->val.val.sub_seg) {
-            this->chain.used_links.remove(prev, link);
-            this->chain.free_links.append(link);
+void Heap::trim(size_t keep_bytes)
+{
+    vector<ChainLink*> links;
+
+    for(auto* link = this->chain.used_links.front; link; link = link->next) {
+        links.push_back(link);
+    }
+
+    /* the largest segments fitting into keep_bytes are kept */
+    auto by_size = links;
+    sort(by_size.begin(), by_size.end(), [](ChainLink* a, ChainLink* b) {
+        return a->val.val.size > b->val.val.size;
+    });
 
+    size_t kept = 0, largest = 0;
+    vector<ChainLink*> released;
+
+    for(auto* link : by_size) {
+        auto size = link->val.val.size;
+
+        if(kept + size <= keep_bytes) {
+            kept   += size;
+            largest = max<size_t>(largest, size);
         } else {
-            prev = link;
-            reset_segment(link->val);
-            this->chain.free_segs.prepend(Size(link->val.val.size, 1), &link->val);
+            released.push_back(link);
         }
+    }
+
+    this->chain.used_links.clear();
 
-        link = next;
+    /* segments of the reserved range stay, only their pages are given back */
+    for(auto* link : links) {
+        if(link->val.val.mapped || find(released.begin(), released.end(), link) == released.end()) {
+            this->chain.used_links.append(link);
+        }
     }
 
-    this->crr_seg = nullptr;
+    for(auto* link : released) {
+        if(link->val.val.mapped) {
+            discard_pages(link->val.val.data, link->val.val.size);
+
+        } else if(!pool_put(link)) {
+            delete link;
+        }
+    }
+
+    /* new segments grow again from the largest one kept */
+    auto grow_from = largest < Max_Cap ? largest : Max_Cap;
+    this->cap = grow_from > Initial_Cap ? grow_from : Initial_Cap;
 }
 
 Heap::~Heap()
@@ -252,7 +673,9 @@ void Heap::destroy()
         auto* link = lst.front;
         while(link) {
             auto* next = link->next;
-            delete link;
+            if(!pool_put(link)) {
+                delete link;
+            }
             link = next;
         }
     };
@@ -262,27 +685,100 @@ void Heap::destroy()
 
     this->chain = Chain();
     this->crr_seg = nullptr;
+    this->clear_free();
+
+    if(this->range.mapping) {
+        unmap_range(this->range.mapping, this->range.mapped);
+    }
+    this->range = Range();
 }
 
 Heap& Heap::operator= (Heap&& m)
 {
     this->destroy();
 
-    this->cap     = m.cap;
-    this->crr_seg = m.crr_seg;
-    this->chain   = m.chain;
+    this->cap        = m.cap;
+    this->crr_seg    = m.crr_seg;
+    this->chain      = m.chain;
+    this->recycle    = m.recycle;
+    this->small_mask = m.small_mask;
+    this->large_mask = m.large_mask;
+    this->dropped    = m.dropped;
+    this->range      = m.range;
+
+    std::copy(std::begin(m.small_free), std::end(m.small_free), this->small_free);
+    std::copy(std::begin(m.large_free), std::end(m.large_free), this->large_free);
 
     m.chain = Chain();
     m.crr_seg = nullptr;
+    m.range = Range();
+    m.clear_free();
 
     return *this;
 }
 
 Heap::Segment::~Segment()
 {
-    if(!this->sub_seg && this->data) {
+    if(this->data && !this->mapped) {
         delete[] this->data;
         this->data = nullptr;
     }
 }
 
+Heap::Stats Heap::stats() const
+{
+    Stats stats;
+
+    for(auto* link = this->chain.used_links.front; link; link = link->next) {
+        stats.segments++;
+        stats.reserved += link->val.val.size;
+    }
+
+    /* tails of segments left behind are in the free lists or dropped */
+    for(auto* link = this->chain.free_segs.front; link; link = link->next) {
+        stats.untouched += link->val.left;
+    }
+    if(this->crr_seg) {
+        stats.untouched += this->crr_seg->left;
+    }
+
+    for(auto i = 0U; i < Small_Lists; i++) {
+        for(auto* block = this->small_free[i]; block; block = block->next) {
+            stats.free += (i + 1) * Granule;
+        }
+    }
+    for(auto* list : this->large_free) {
+        for(auto* block = list; block; block = block->next) {
+            stats.free += block->size;
+        }
+    }
+
+    stats.wasted        = this->dropped;
+    stats.used          = stats.reserved - stats.untouched - stats.free - stats.wasted;
+    stats.address_space = this->range.size;
+
+    return stats;
+}
+
+Heap::Stats& Heap::Stats::operator+= (const Stats& s)
+{
+    this->segments      += s.segments;
+    this->reserved      += s.reserved;
+    this->used          += s.used;
+    this->free          += s.free;
+    this->wasted        += s.wasted;
+    this->untouched     += s.untouched;
+    this->address_space += s.address_space;
+
+    return *this;
+}
+
+void Srl::pool_segments(bool enable)
+{
+    pool_enabled.store(enable, memory_order_relaxed);
+
+    if(!enable) {
+        local_pool.drain();
+        global_pool.drain();
+    }
+}
@@ -7,8 +7,6 @@ using namespace Lib;
 
 namespace {
 
-    int MAX_SAFE_NESTED_SCOPE_DEPTH = 128;
-
     template<class T> const string& tp_name();
     template<> const string& tp_name<Node>()  { static const string str = "Node";  return str; }
     template<> const string& tp_name<Value>() { static const string str = "Value"; return str; }
@@ -56,17 +54,43 @@ namespace {
     template<Option Opt, class T> typename enable_if<enabled(Opt, Address), bool>::type
     compare(Itr<T>& itr, T* pointer) { return &itr->field == pointer; }
 
+    /* walk from the closest of list begin, list end and the last accessed link */
+    template<class T>
+    Itr<T> seek(size_t index, Cont<T>& links, const Cursor<T>& cursor)
+    {
+        auto size = links.size();
+
+        if(cursor.set) {
+            auto dist = index > cursor.index ? index - cursor.index : cursor.index - index;
+
+            if(dist <= index && dist < size - index) {
+                auto itr = cursor.itr;
+                advance(itr, (ptrdiff_t)index - (ptrdiff_t)cursor.index);
+                return itr;
+            }
+        }
+
+        if(index <= size / 2) {
+            return next(links.begin(), index);
+        }
+
+        return prev(links.end(), size - index);
+    }
+
     template<Option Opt,  class T>
-    Link<T>* get_link_at_index(size_t index, Cont<T>& links)
+    Link<T>* get_link_at_index(size_t index, Cont<T>& links, Cursor<T>& cursor)
     {
         if(index < links.size()) {
-            auto itr = links.begin();
-            advance(itr, index);
+            auto itr = seek(index, links, cursor);
             auto* rslt = &*itr;
             if(enabled(Opt, Remove)) {
                 links.erase(itr);
+                cursor.set = false;
                 return nullptr;
             }
+            cursor.itr   = itr;
+            cursor.index = index;
+            cursor.set   = true;
             return rslt;
 
         } else {
@@ -121,16 +145,101 @@ namespace {
             : env.hash_string(str);
     }
 
+    /* Searches from both ends at once. Fields restored in the order they are stored are found
+     * at the front, fields restored in reversed order at the back, both in constant time. */
     template<class T>
-    Itr<T> find_link_iterator(const String& name, Cont<T>& links, Environment& env)
+    Itr<T> find_link_iterator(const String& name, uint64_t hash, Cont<T>& links)
     {
-        auto hash = hash_string(name, env);
+        auto front = links.begin();
+        auto back  = links.end();
 
-        for(auto itr = links.begin(), end = links.end(); itr != end; itr++) {
+        while(front != back) {
+            if(compare<Hash, T>(front, hash) && compare<Name, T>(front, name)) {
+                return front;
+            }
 
-            if(compare<Hash, T>(itr, hash) && compare<Name, T>(itr, name)) {
-                return itr;
+            if(++front == back) {
+                break;
+            }
+
+            --back;
+            if(compare<Hash, T>(back, hash) && compare<Name, T>(back, name)) {
+                return back;
+            }
+        }
+
+        return links.end();
+    }
+
+    /* slots are only filled when empty, so links of the same name are probed in list order */
+    template<class T>
+    void index_link(LinkIndex<T>& index, Itr<T> itr)
+    {
+        auto mask = index.cap - 1;
+        auto pos  = itr->hash & mask;
+
+        while(index.slots[pos].state != LinkIndex<T>::State::Empty) {
+            pos = (pos + 1) & mask;
+        }
+
+        index.slots[pos] = { itr, itr->hash, LinkIndex<T>::State::Used };
+        index.indexed++;
+    }
+
+    /* takes in links appended since the last lookup, rebuilds the index once deleted slots pile up */
+    template<class T>
+    void update_index(LinkIndex<T>& index, Cont<T>& links, Heap& heap)
+    {
+        auto n_new = index.built ? links.size() - index.indexed : links.size();
+
+        if(!index.built || (index.indexed + index.deleted + n_new) * 2 > index.cap) {
+            auto cap = index.cap;
+            while(cap < 16 || links.size() * 4 > cap) {
+                cap = cap < 16 ? 16 : cap * 2;
+            }
+
+            if(cap != index.cap) {
+                if(index.slots) {
+                    heap.put_mem((uint8_t*)index.slots, index.cap * sizeof(*index.slots));
+                }
+                index.slots = heap.get_mem<typename LinkIndex<T>::Slot>(cap);
+                index.cap   = cap;
+            }
+
+            for(auto i = 0U; i < cap; i++) {
+                index.slots[i].state = LinkIndex<T>::State::Empty;
+            }
+
+            index.indexed = 0;
+            index.deleted = 0;
+            index.built   = true;
+            n_new         = links.size();
+        }
+
+        for(auto itr = prev(links.end(), n_new); itr != links.end(); itr++) {
+            index_link(index, itr);
+        }
+    }
+
+    /* finds a buffered link and drops it from the index, the caller erases it */
+    template<class T>
+    Itr<T> take_link(const String& name, uint64_t hash, Cont<T>& links, LinkIndex<T>& index, Heap& heap)
+    {
+        if(!index.built && links.size() <= LinkIndex<T>::Min_Links) {
+            return find_link_iterator(name, hash, links);
+        }
 
+        update_index(index, links, heap);
+
+        auto mask = index.cap - 1;
+
+        for(auto pos = hash & mask; index.slots[pos].state != LinkIndex<T>::State::Empty; pos = (pos + 1) & mask) {
+            auto& slot = index.slots[pos];
+            if(slot.state == LinkIndex<T>::State::Used && slot.hash == hash && compare<Name, T>(slot.itr, name)) {
+                slot.state = LinkIndex<T>::State::Deleted;
+                index.indexed--;
+                index.deleted++;
+                return slot.itr;
             }
         }
 
@@ -143,16 +252,119 @@ namespace {
     }
 }
 
+namespace Srl { namespace Lib {
+
+    /* name of a field looked up in a node, the hash is computed on first use
+     * unless it is known upfront */
+    struct FieldId {
+
+        FieldId(const String& name_, Environment& env_) : name(name_), env(&env_) { }
+        FieldId(const Key& key) : name(key), hsh(key.hash()), hashed(true) { }
+
+        const String name;
+
+        uint64_t hash()
+        {
+            if(!this->hashed) {
+                this->hsh    = hash_string(this->name, *this->env);
+                this->hashed = true;
+            }
+            return this->hsh;
+        }
+
+        String utf8() const
+        {
+            return this->env ? this->env->conv_string(this->name) : this->name;
+        }
+
+    private:
+        Environment* env    = nullptr;
+        uint64_t     hsh    = 0;
+        bool         hashed = false;
+    };
+} }
+
 void Node::insert_value(const Value& new_value, const String& name_)
 {
     if(this->env->parsing) {
         this->env->write(new_value, name_);
 
     } else {
+        this->unpack();
         this->env->store_value(*this, new_value, name_);
     }
 }
 
+void Node::insert_array(const Value& array, const String& name_)
+{
+    if(this->env->parsing) {
+        this->env->write(array, name_);
+
+    } else {
+        this->env->store_array(*this, array, name_);
+    }
+}
+
+void Node::unpack()
+{
+    if(!this->is_packed()) {
+        return;
+    }
+
+    auto elem_size = TpTools::get_size(this->packed_type);
+
+    for(size_t offset = 0; offset < this->packed.size; offset += elem_size) {
+        auto elem = Tools::bytes_to_type(this->packed.ptr + offset, this->packed_type);
+        this->env->store_value(*this, elem, Environment::EmptyString);
+    }
+
+    this->packed_type = Type::Null;
+    this->packed      = MemBlock();
+}
+
+Value Node::packed_value() const
+{
+    return Value(this->packed, Type::Array, this->packed_type);
+}
+
+void Node::rebind(Environment* env_)
+{
+    this->env = env_;
+    /* the index lives in the heap of the old environment */
+    this->nodes_index.reset();
+    this->values_index.reset();
+
+    for(auto& n : this->nodes) {
+        n.field.rebind(env_);
+    }
+}
+
+Node Node::child_node(const Value& scope_start)
+{
+    Node node(this->env->tree, scope_start.type(), false);
+
+    /* packed arrays have no scope end, they are complete once read */
+    if(scope_start.elem_type() != Type::Null) {
+        node.packed      = MemBlock(scope_start.data(), scope_start.size());
+        node.packed_type = scope_start.elem_type();
+        node.parsed      = true;
+    }
+
+    return node;
+}
+
+Link<Node>* Node::store_scope(const Value& scope_start, const String& name_, int scope_depth)
+{
+    if(scope_start.elem_type() != Type::Null) {
+        return this->env->store_array(*this, scope_start, name_);
+    }
+
+    auto* link = this->env->store_node(*this, Node(this->env->tree, scope_start.type()), name_);
+    link->field.read_source(scope_depth);
+
+    return link;
+}
+
 Node& Node::insert_node(const Node& new_node, const String& name_)
 {
     return this->env->store_node(*this, new_node, name_)->field;
@@ -181,19 +393,53 @@ Node& Node::node(const String& name_)
     return link->field;
 }
 
+Value& Node::value(const Key& key)
+{
+    const String name_ = key;
+    auto hash_name = make_pair(key.hash(), &name_);
+    auto* link = find_link<Throw | Hash | Name>(hash_name, this->values, name_, this->name());
+
+    return link->field;
+}
+
+Node& Node::node(const Key& key)
+{
+    const String name_ = key;
+    auto hash_name = make_pair(key.hash(), &name_);
+    auto* link = find_link<Throw | Hash | Name>(hash_name, this->nodes, name_, this->name());
+
+    return link->field;
+}
+
 
 Value& Node::value(size_t index)
 {
-    auto* link = get_link_at_index<Throw>(index, this->values);
+    this->unpack();
+    auto* link = get_link_at_index<Throw>(index, this->values, this->values_cursor);
     return link->field;
 }
 
 Node& Node::node(size_t index)
 {
-    auto* link = get_link_at_index<Throw>(index, this->nodes);
+    auto* link = get_link_at_index<Throw>(index, this->nodes, this->nodes_cursor);
     return link->field;
 }
 
+Value Node::element(size_t index)
+{
+    if(!this->is_packed()) {
+        return this->value(index);
+    }
+
+    if(index >= this->num_values()) {
+        throw Exception("Cannot access <Value> at index <" + to_string(index) + ">, index out of bounds.");
+    }
+
+    auto offset = index * TpTools::get_size(this->packed_type);
+
+    return Tools::bytes_to_type(this->packed.ptr + offset, this->packed_type);
+}
+
 
 optional<Union> Node::try_get(const String& name_)
 {
@@ -232,52 +478,27 @@ Union Node::get(const String& name_)
 
 Union Node::get(size_t index)
 {
-    auto* resnode = get_link_at_index<None>(index, this->nodes);
+    auto* resnode = get_link_at_index<None>(index, this->nodes, this->nodes_cursor);
 
     if(resnode) {
         return Union(resnode->field);
     }
 
-    auto* resvalue = get_link_at_index<None>(index, this->values);
+    this->unpack();
+    auto* resvalue = get_link_at_index<None>(index, this->values, this->values_cursor);
 
     return Union(resvalue->field);
 }
 
 void Node::read_source(int scope_depth)
 {
-    auto& parser = *this->env->parser;
-    auto& source = this->env->in;
-
-    while(true) {
-
-        MemBlock seg_name; Value val;
-        tie(seg_name, val) = parser.read(source);
-
-        if(val.type() == Type::Scope_End) {
-            this->parsed = true;
-            break;
-        }
-
-        auto field_name = String(seg_name, Encoding::UTF8);
-
-        if(!TpTools::is_scope(val.type())) {
-            this->env->store_value(*this, val, field_name);
-
-        } else {
-
-            if(scope_depth + 1 > MAX_SAFE_NESTED_SCOPE_DEPTH) {
-                throw Exception("Abort parsing data MAX_SAFE_NESTED_SCOPE_DEPTH [" + to_string(MAX_SAFE_NESTED_SCOPE_DEPTH) + "] exceeded");
-            }
-
-            auto* link = this->env->store_node(*this, Node(this->env->tree, val.type()), field_name);
-
-            link->field.read_source(scope_depth + 1);
-        }
-    }
+    this->env->pipeline->read_source(*this, scope_depth);
 }
 
 Union Node::consume_item(const String& id, bool throw_err)
 {
+    SRL_COUNT(field_lookups, 1);
+
     auto* storednode = find_link<Name>(id, this->nodes);
 
     if(storednode) {
@@ -295,7 +516,7 @@ Union Node::consume_item(const String& id, bool throw_err)
     while(!this->parsed) {
 
         MemBlock seg_name; Value val;
-        tie(seg_name, val) = this->env->parser->read(this->env->in);
+        tie(seg_name, val) = this->env->read();
 
         auto tp = val.type();
 
@@ -305,13 +526,14 @@ Union Node::consume_item(const String& id, bool throw_err)
         }
 
         if(TpTools::is_scope(tp)) {
-            auto* link = this->env->store_node(*this, Node(this->env->tree, tp), seg_name);
-            link->field.read_source();
+            SRL_COUNT(fields_buffered, 1);
+            auto* link = this->store_scope(val, seg_name);
             if(link->hash == hash && link->field.name() == id) {
                 return Union(link->field);
             }
 
         } else {
+            SRL_COUNT(fields_buffered, 1);
             auto* link = this->env->store_value(*this, val, seg_name);
             if(link->hash == hash && link->field.name() == id) {
                 return Union(link->field);
@@ -328,20 +550,51 @@ Union Node::consume_item(const String& id, bool throw_err)
 
 Node Node::consume_node(bool throw_ex, const String& id)
 {
-    auto stored_itr = find_link_iterator(id, this->nodes, *this->env);
+    FieldId field_id(id, *this->env);
+    return this->consume_node(throw_ex, field_id);
+}
 
-    if(stored_itr != this->nodes.end()) {
-        auto stored_field = move(stored_itr->field);
-        this->nodes.erase(stored_itr);
-        return stored_field;
+Node Node::consume_node(bool throw_ex, const Key& key)
+{
+    FieldId field_id(key);
+    return this->consume_node(throw_ex, field_id);
+}
+
+Value Node::consume_value(bool throw_ex, const String& id)
+{
+    FieldId field_id(id, *this->env);
+    return this->consume_value(throw_ex, field_id);
+}
+
+Value Node::consume_value(bool throw_ex, const Key& key)
+{
+    FieldId field_id(key);
+    return this->consume_value(throw_ex, field_id);
+}
+
+Node Node::consume_node(bool throw_ex, FieldId& id)
+{
+    SRL_COUNT(field_lookups, 1);
+
+    /* fields restored in the order they were stored never get buffered,
+     * so hashing and scanning is only needed when something was stored */
+    if(!this->nodes.empty()) {
+        auto stored_itr = take_link(id.name, id.hash(), this->nodes, this->nodes_index, this->env->heap);
+
+        if(stored_itr != this->nodes.end()) {
+            auto stored_field = move(stored_itr->field);
+            this->nodes.erase(stored_itr);
+            this->nodes_cursor.set = false;
+            return stored_field;
+        }
     }
 
-    auto id_conv = this->env->conv_string(id);
+    auto id_conv = id.utf8();
 
     while(!this->parsed) {
 
         MemBlock seg_name; Value val;
-        tie(seg_name, val) = this->env->parser->read(this->env->in);
+        tie(seg_name, val) = this->env->read();
 
         auto tp = val.type();
 
@@ -352,40 +605,46 @@ Node Node::consume_node(bool throw_ex, const String& id)
 
         if(TpTools::is_scope(tp)) {
             if(compare(id_conv, seg_name)) {
-                return Node(this->env->tree, tp, false);
+                return this->child_node(val);
             }
 
-            auto* link = this->env->store_node(*this, Node(this->env->tree, tp), seg_name);
-            link->field.read_source();
+            SRL_COUNT(fields_buffered, 1);
+            this->store_scope(val, seg_name);
 
         } else {
+            SRL_COUNT(fields_buffered, 1);
             this->env->store_value(*this, val, seg_name);
         }
     }
 
     if(throw_ex) {
-        throw field_name_not_found_ex(id, this->name());
+        throw field_name_not_found_ex(id.name, this->name());
     }
 
     return Node(this->env->tree);
 }
 
-Value Node::consume_value(bool throw_ex, const String& id)
+Value Node::consume_value(bool throw_ex, FieldId& id)
 {
-    auto stored_itr = find_link_iterator(id, this->values, *this->env);
+    SRL_COUNT(field_lookups, 1);
 
-    if(stored_itr != this->values.end()) {
-        auto stored_field = move(stored_itr->field);
-        this->values.erase(stored_itr);
-        return stored_field;
+    if(!this->values.empty()) {
+        auto stored_itr = take_link(id.name, id.hash(), this->values, this->values_index, this->env->heap);
+
+        if(stored_itr != this->values.end()) {
+            auto stored_field = move(stored_itr->field);
+            this->values.erase(stored_itr);
+            this->values_cursor.set = false;
+            return stored_field;
+        }
     }
 
-    auto name_conv = this->env->conv_string(id);
+    auto name_conv = id.utf8();
 
     while(!this->parsed) {
 
         MemBlock seg_name; Value val;
-        tie(seg_name, val) = this->env->parser->read(this->env->in);
+        tie(seg_name, val) = this->env->read();
 
         auto tp = val.type();
 
@@ -399,16 +658,17 @@ Value Node::consume_value(bool throw_ex, const String& id)
                 return val;
             }
 
+            SRL_COUNT(fields_buffered, 1);
             this->env->store_value(*this, val, seg_name);
 
         } else {
-            auto* link = this->env->store_node(*this, Node(this->env->tree, tp), seg_name);
-            link->field.read_source();
+            SRL_COUNT(fields_buffered, 1);
+            this->store_scope(val, seg_name);
         }
     }
 
     if(throw_ex) {
-        throw field_name_not_found_ex(id, this->name());
+        throw field_name_not_found_ex(id.name, this->name());
     }
 
     return Value(Type::Null);
@@ -421,6 +681,8 @@ Node Node::consume_node(bool throw_ex, size_t)
         auto itr = this->nodes.begin();
         auto stored_field = move(itr->field);
         this->nodes.erase(itr);
+        this->nodes_cursor.set = false;
+        this->nodes_index.clear();
 
         return stored_field;
     }
@@ -428,7 +690,7 @@ Node Node::consume_node(bool throw_ex, size_t)
 
     while(!this->parsed) {
         MemBlock seg_name; Value val;
-        tie(seg_name, val) = this->env->parser->read(this->env->in);
+        tie(seg_name, val) = this->env->read();
 
         auto tp = val.type();
 
@@ -438,12 +700,13 @@ Node Node::consume_node(bool throw_ex, size_t)
         }
 
         if(TpTools::is_scope(tp)) {
-            Node node(this->env->tree, tp, false);
+            auto node = this->child_node(val);
             node.name_ptr = this->env->store_string(seg_name).first;
 
             return node;
 
         } else {
+            SRL_COUNT(fields_buffered, 1);
             this->env->store_value(*this, val, seg_name);
         }
     }
@@ -461,13 +724,15 @@ Value Node::consume_value(bool throw_ex, size_t)
         auto itr = this->values.begin();
         auto stored_field = move(itr->field);
         this->values.erase(itr);
+        this->values_cursor.set = false;
+        this->values_index.clear();
 
         return stored_field;
     }
 
     while(!this->parsed) {
         MemBlock seg_name; Value val;
-        tie(seg_name, val) = this->env->parser->read(this->env->in);
+        tie(seg_name, val) = this->env->read();
 
         auto tp = val.type();
 
@@ -481,8 +746,8 @@ Value Node::consume_value(bool throw_ex, size_t)
             return val;
 
         } else {
-            auto* link = this->env->store_node(*this, Node(this->env->tree, tp), seg_name);
-            link->field.read_source();
+            SRL_COUNT(fields_buffered, 1);
+            this->store_scope(val, seg_name);
         }
     }
 
@@ -495,33 +760,22 @@ Value Node::consume_value(bool throw_ex, size_t)
 
 void Node::to_source()
 {
-    Value scope_start = Value(this->scope_type);
-
-    this->env->write(scope_start, this->name());
-
-    for(auto& v : this->values) {
-        this->env->write(v.field, v.field.name());
-    }
-
-    for(auto& n : this->nodes) {
-        n.field.to_source();
-    }
-
-    Value scope_end = Value(Type::Scope_End);
-    this->env->write(scope_end, *this->name_ptr);
+    this->env->pipeline->to_source(*this);
 }
 
 void Node::consume_scope()
 {
     int depth = 0;
 
-    auto& parser = *this->env->parser;
-    auto& source = this->env->in;
-
     while(!this->parsed) {
-        auto tp = parser.read(source).second.type();
+        auto val = this->env->read().second;
+        auto tp  = val.type();
+
         if(TpTools::is_scope(tp)) {
-            depth++;
+            /* packed arrays don't open a scope */
+            if(val.elem_type() == Type::Null) {
+                depth++;
+            }
             continue;
         }
 
@@ -572,6 +826,8 @@ void Node::foreach_node(const function<void(Node&)>& fnc, bool recursive)
 
 void Node::foreach_value(const function<void(Value&)>& fnc, bool recursive)
 {
+    this->unpack();
+
     for(auto& link : this->values) {
         fnc(link.field);
     }
@@ -634,31 +890,44 @@ list<Value*> Node::all_values(bool recursive)
 void Node::remove_node(const String& name_)
 {
     find_link<Remove | Name>(name_, this->nodes, name_);
+    this->nodes_cursor.set = false;
+    this->nodes_index.clear();
 }
 
 void Node::remove_node(size_t index)
 {
-    get_link_at_index<Remove>(index, this->nodes);
+    get_link_at_index<Remove>(index, this->nodes, this->nodes_cursor);
+    this->nodes_index.clear();
 }
 
 void Node::remove_node(Node* to_remove)
 {
     find_link<Remove | Address>(to_remove, this->nodes);
+    this->nodes_cursor.set = false;
+    this->nodes_index.clear();
 }
 
 void Node::remove_value(const String& name_)
 {
+    this->unpack();
     find_link<Remove | Name>(name_, this->values, name_);
+    this->values_cursor.set = false;
+    this->values_index.clear();
 }
 
 void Node::remove_value(size_t index)
 {
-    get_link_at_index<Remove>(index, this->values);
+    this->unpack();
+    get_link_at_index<Remove>(index, this->values, this->values_cursor);
+    this->values_index.clear();
 }
 
 void Node::remove_value(Value* to_remove)
 {
+    this->unpack();
     find_link<Remove | Address>(to_remove, this->values);
+    this->values_cursor.set = false;
+    this->values_index.clear();
 }
 
 bool Node::has_node(const String& field_name)
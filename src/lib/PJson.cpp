@@ -23,6 +23,17 @@ namespace {
         return Tools::conv_charset(Encoding::UTF8, String(hex_buffer, 2, Encoding::UTF16), buf, true, idx);
     };
 
+    /* characters scanning a top level array has to look at */
+    struct ScanChars {
+        bool table[256] = { };
+        ScanChars()
+        {
+            for(auto c : { '\"', '/', '{', '}', '[', ']', ',' }) {
+                table[(uint8_t)c] = true;
+            }
+        }
+    } const scan_chars;
+
     constexpr array<const char, 2> ar(const char c)
     {
         return array<const char, 2> { { '\\', c } };
@@ -259,16 +270,22 @@ void PJson::process_quote(In& source, State& state)
     source.move(1, error);
 
     auto& buffer = state.name_processed ? this->value_buffer : this->name_buffer;
+    auto* start = source.pointer();
     MemBlock block = read_unescape(source, buffer);
 
-    this->process_string(block, state);
+    /* escape sequences always shrink, equal lengths mean the string is verbatim in the source */
+    if(!source.is_streaming() && (size_t)(source.pointer() - start) == block.size) {
+        this->process_string({ start, block.size }, state, true);
+    } else {
+        this->process_string(block, state, false);
+    }
 }
 
-void PJson::process_string(const MemBlock& content, State& state)
+void PJson::process_string(const MemBlock& content, State& state, bool borrowed)
 {
     /* container elements don't have a name */
     if(state.reading_value || this->scope_type == Type::Array) {
-        state.value = Value(content, Encoding::UTF8);
+        state.value = Value(content, Type::String, Encoding::UTF8, borrowed);
         state.complete = true;
 
     } else {
@@ -329,9 +346,129 @@ void PJson::throw_exception(State& state, const String& info)
     throw Exception("Unable to parse JSON document. " + info.unwrap<char>(false) + " " + msg);
 }
 
+/* Elements of a top level array are found by brackets and commas alone,
+ * only strings and comments need to be skipped */
+vector<size_t> PJson::scan_array(const MemBlock& source)
+{
+    const auto* data = source.ptr;
+    const size_t size = source.size;
+    size_t pos = 0;
+
+    const auto malformed = [] {
+        throw Exception("Unable to parse JSON document. Top level array malformed.");
+    };
+
+    const auto skip_comment = [&] {
+        if(pos + 1 < size && data[pos + 1] == '*') {
+            for(pos += 2; pos + 1 < size && !(data[pos] == '*' && data[pos + 1] == '/'); pos++) { }
+            pos += 2;
+
+        } else {
+            for(; pos < size && data[pos] != '\n' && data[pos] != '\r'; pos++) { }
+        }
+    };
+
+    const auto skip_space = [&](bool commas) {
+        while(pos < size) {
+            auto c = data[pos];
+            if(c == '/') {
+                skip_comment();
+            } else if(c == ' ' || c == '\n' || c == '\t' || c == '\r' || (commas && c == ',')) {
+                pos++;
+            } else {
+                break;
+            }
+        }
+    };
+
+    skip_space(false);
+    if(pos >= size || data[pos] != '[') {
+        malformed();
+    }
+    pos++;
+
+    vector<size_t> offsets;
+
+    while(true) {
+        skip_space(true);
+
+        if(pos >= size) {
+            malformed();
+        }
+        offsets.push_back(pos);
+
+        if(data[pos] == ']') {
+            return offsets;
+        }
+
+        size_t depth = 0;
+
+        for(; pos < size; pos++) {
+            while(pos < size && !scan_chars.table[data[pos]]) {
+                pos++;
+            }
+            if(pos >= size) {
+                break;
+            }
+
+            auto c = data[pos];
+
+            if(c == '\"') {
+                /* closing quote is the first one not preceded by an odd number of backslashes */
+                while(true) {
+                    auto* quote = (const uint8_t*)memchr(data + pos + 1, '\"', size - pos - 1);
+                    if(!quote) {
+                        pos = size;
+                        break;
+                    }
+                    pos = quote - data;
+
+                    size_t slashes = 0;
+                    while(data[pos - 1 - slashes] == '\\') {
+                        slashes++;
+                    }
+                    if(slashes % 2 == 0) {
+                        break;
+                    }
+                }
+
+            } else if(c == '/') {
+                skip_comment();
+                pos--;
+
+            } else if(c == '{' || c == '[') {
+                depth++;
+
+            } else if(c == '}' || c == ']') {
+                if(depth == 0) {
+                    break;
+                }
+                if(--depth == 0) {
+                    pos++;
+                    break;
+                }
+
+            } else if(c == ',' && depth == 0) {
+                break;
+            }
+        }
+    }
+}
+
+void PJson::resume(const Parser&, size_t)
+{
+    this->scope_stack.push(Type::Array);
+    this->scope_type = Type::Array;
+}
+
 void PJson::clear()
 {
     Aux::clear_stack(this->scope_stack);
     this->scope_type = Type::Null;
     this->scope_closed = true;
 }
+
+const Pipeline& PJson::pipeline() const
+{
+    return Pipeline::of<PJson>();
+}
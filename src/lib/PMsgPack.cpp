@@ -302,7 +302,7 @@ namespace {
         auto size = get_str_size(prefix, in);
         auto block = in.read_block(size, error);
 
-        return Value(block, Type::String, Encoding::UTF8);
+        return Value(block, Type::String, Encoding::UTF8, !in.is_streaming());
     }
 
     Value read_bin(uint8_t prefix, In& in)
@@ -310,7 +310,7 @@ namespace {
         auto size = get_bin_size(prefix, in);
         auto block = in.read_block(size, error);
 
-        return Value(block, Type::Binary);
+        return Value(block, Type::Binary, Encoding::Unknown, !in.is_streaming());
     }
 
     /* FixMap    1000xxxx 0x80 - 0x8f
@@ -473,3 +473,8 @@ void PMsgPack::clear()
     Aux::clear_stack(this->scope_stack);
     this->scope = nullptr;
 }
+
+const Pipeline& PMsgPack::pipeline() const
+{
+    return Pipeline::of<PMsgPack>();
+}
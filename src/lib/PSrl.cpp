@@ -31,14 +31,25 @@ namespace {
     const Flag FString = 1 << 5;
     const Flag FObject = 1 << 6;
     const Flag FArray  = 1 << 7;
+    /* array + binary -> packed scalar array */
+    const Flag FPacked = FArray | FBinary;
+    /* null + string -> polymorphic type id, null + binary -> index of an earlier type id */
+    const Flag FTypeId    = FNull | FString;
+    const Flag FTypeIndex = FNull | FBinary;
     /* no flags set -> scope end */
 
-    bool is_scope (Flag flag) { return !(flag & FNum) && flag & (FObject | FArray); }
+    bool is_scope   (Flag flag) { return !(flag & FNum) && flag & (FObject | FArray); }
+    bool is_packed  (Flag flag) { return !(flag & FNum) && (flag & FPacked) == FPacked; }
+    bool is_type_id (Flag flag) { return !(flag & FNum) && flag & FNull && flag & (FString | FBinary); }
 
     Flag build_flag(const Value& val)
     {
         auto tp = val.type();
 
+        if(val.is_type_id() && (tp == Type::String || TpTools::is_integral(tp))) {
+            return tp == Type::String ? FTypeId : FTypeIndex;
+        }
+
         if(TpTools::is_num(tp) && TpTools::is_integral(tp)) {
             return FNum | (TpTools::is_signed(tp) && val.pblock().i64 < 0 ? FSigned : 0);
         }
@@ -52,7 +63,8 @@ namespace {
         }
 
         if(TpTools::is_scope(tp)) {
-            return tp == Type::Array ? FArray : FObject;
+            return val.elem_type() != Type::Null ? FPacked
+                 : tp == Type::Array ? FArray : FObject;
         }
 
         if(tp == Type::Bool) {
@@ -186,6 +198,16 @@ void PSrl::write(const Value& value, const MemBlock& name, Out& out)
     this->write_head(flag, name, out);
 
     auto type = value.type();
+
+    /* packed arrays: element type, byte size, raw elements */
+    if(value.elem_type() != Type::Null) {
+        out.write_byte((uint8_t)value.elem_type());
+        encode_integer(value.size(), out);
+        out.write(value.data(), value.size());
+
+        return;
+    }
+
     /* scope-starts carry no additional information */
     if(TpTools::is_scope(type)) {
         this->push_scope(type);
@@ -234,6 +256,10 @@ pair<Lib::MemBlock, Value> PSrl::read(In& source)
         return { MemBlock(), Type::Scope_End };
     }
 
+    if(is_packed(flag)) {
+        return this->read_packed(name, source);
+    }
+
     if(is_scope(flag)) {
         auto tp = flag & FObject ? Type::Object : Type::Array;
         this->push_scope(tp);
@@ -245,13 +271,17 @@ pair<Lib::MemBlock, Value> PSrl::read(In& source)
         return this->read_num(flag, name, source);
     }
 
+    if(is_type_id(flag)) {
+        return this->read_type_id(flag, name, source);
+    }
+
 
     if(flag & (FBinary | FString)) {
         auto size  = decode_integer(source);
         auto block = source.read_block(size, error);
         auto type = flag & FBinary ? Type::Binary : Type::String;
 
-        return { name, Value(block, type, Encoding::UTF8) };
+        return { name, Value(block, type, Encoding::UTF8, !source.is_streaming()) };
     }
 
     if(flag & FNull) {
@@ -288,6 +318,37 @@ pair<Lib::MemBlock, Value> PSrl::read_num(Flag flag, const MemBlock& name, In& s
         : make_pair(name, Value(integer));
 }
 
+pair<Lib::MemBlock, Value> PSrl::read_type_id(Flag flag, const MemBlock& name, In& source)
+{
+    if(flag & FBinary) {
+        return { name, Value(decode_integer(source)).as_type_id() };
+    }
+
+    auto size  = decode_integer(source);
+    auto block = source.read_block(size, error);
+
+    return { name, Value(block, Type::String, Encoding::UTF8, !source.is_streaming()).as_type_id() };
+}
+
+pair<Lib::MemBlock, Value> PSrl::read_packed(const MemBlock& name, In& source)
+{
+    auto elem_type = (Type)source.read_move<uint8_t>(error);
+
+    if(!TpTools::is_num(elem_type)) {
+        error();
+    }
+
+    auto size = decode_integer(source);
+
+    if(size % TpTools::get_size(elem_type) != 0 || size > numeric_limits<uint32_t>::max()) {
+        error();
+    }
+
+    auto block = source.read_block(size, error);
+
+    return { name, Value(block, Type::Array, elem_type) };
+}
+
 void PSrl::push_scope(Type scope_type)
 {
     this->scope_stack.push(scope_type);
@@ -302,6 +363,15 @@ void PSrl::pop_scope()
         : Type::Null;
 }
 
+void PSrl::resume(const Parser& scanner, size_t mark)
+{
+    /* names are indexed in document order, an element knows those stored before it */
+    auto& strings = static_cast<const PSrl&>(scanner).indexed_strings;
+    this->indexed_strings.assign(strings.begin(), strings.begin() + mark);
+
+    this->push_scope(Type::Array);
+}
+
 void PSrl::clear()
 {
     this->indexed_strings.clear();
@@ -311,3 +381,8 @@ void PSrl::clear()
 
     Aux::clear_stack(this->scope_stack);
 }
+
+const Pipeline& PSrl::pipeline() const
+{
+    return Pipeline::of<PSrl>();
+}
@@ -5,6 +5,24 @@ using namespace std;
 using namespace Srl;
 using namespace Lib;
 
+namespace {
+
+    const size_t npos = numeric_limits<size_t>::max();
+
+    size_t floor_log2(size_t n)
+    {
+        size_t log = 0;
+        while(n >>= 1) {
+            log++;
+        }
+        return log;
+    }
+
+    size_t first_bucket(uint64_t hash, size_t cap)
+    {
+        return (hash ^ hash >> 32) & (cap - 1);
+    }
+}
 
 Registrations* Lib::registrations()
 {
@@ -12,15 +30,237 @@ Registrations* Lib::registrations()
     return &regs;
 }
 
-bool Registrations::insert(const String& id, Registrations::Make&& make)
+Registrations::Registrations()
 {
-    bool exists; void* v;
-    tie(exists, v) = this->table.insert(id, make);
+    for(auto& chunk : this->chunks) {
+        chunk.store(nullptr, memory_order_relaxed);
+    }
+}
+
+Registrations::~Registrations()
+{
+    for(auto& chunk : this->chunks) {
+        delete[] chunk.load(memory_order_relaxed);
+    }
+}
+
+const Registrations::Entry& Registrations::entry(size_t slot) const
+{
+    auto chunk = floor_log2(slot / First_Chunk + 1);
+    auto first = First_Chunk * (((size_t)1 << chunk) - 1);
+
+    return this->chunks[chunk].load(memory_order_acquire)[slot - first];
+}
+
+bool Registrations::insert(const String& id, Make make_)
+{
+    lock_guard<std::mutex> lock (this->mutex);
+
+    auto hash = Aux::hash_fnc(id.data(), id.size());
+    auto* idx = this->index.load(memory_order_relaxed);
+
+    if(idx && this->slot_of(idx, id, hash) != npos) {
+        return true;
+    }
+
+    auto slot  = this->n_entries;
+    auto chunk = floor_log2(slot / First_Chunk + 1);
+    auto first = First_Chunk * (((size_t)1 << chunk) - 1);
+
+    if(chunk >= Chunks) {
+        throw Exception("Too many registered types.");
+    }
+
+    auto* entries = this->chunks[chunk].load(memory_order_relaxed);
+    if(!entries) {
+        entries = new Entry[First_Chunk << chunk];
+        this->chunks[chunk].store(entries, memory_order_release);
+    }
+
+    auto& entry = entries[slot - first];
+    entry.id    = id.unwrap(false);
+    entry.hash  = hash;
+    entry.slot  = slot;
+    entry.make  = make_;
+
+    this->n_entries++;
+
+    /* at most half of the buckets are taken */
+    if(!idx || this->n_entries * 2 > idx->cap) {
+        this->grow();
+
+    } else {
+        this->place(idx, entry);
+    }
+
+    return false;
+}
+
+void Registrations::grow()
+{
+    auto* current = this->index.load(memory_order_relaxed);
+    auto  cap     = current ? current->cap * 2 : First_Chunk * 4;
+
+    auto* idx = new Index(cap);
+    this->indices.emplace_back(idx);
+
+    for(auto slot = 0U; slot < this->n_entries; slot++) {
+        this->place(idx, this->entry(slot));
+    }
+
+    this->index.store(idx, memory_order_release);
+}
+
+void Registrations::place(Index* idx, const Entry& entry)
+{
+    auto mask = idx->cap - 1;
+
+    for(auto bucket = first_bucket(entry.hash, idx->cap); ; bucket = (bucket + 1) & mask) {
+        if(!idx->buckets[bucket].load(memory_order_relaxed)) {
+            idx->buckets[bucket].store(&entry, memory_order_release);
+            return;
+        }
+    }
+}
+
+size_t Registrations::slot_of(const Index* idx, const String& id, uint64_t hash) const
+{
+    auto mask = idx->cap - 1;
+
+    /* an empty bucket ends the probe, half of them are empty */
+    for(auto bucket = first_bucket(hash, idx->cap); ; bucket = (bucket + 1) & mask) {
+        auto* entry = idx->buckets[bucket].load(memory_order_acquire);
+
+        if(!entry) {
+            return npos;
+        }
+
+        auto& name = entry->id;
+
+        if(entry->hash == hash && String((const uint8_t*)name.data(), name.size(), Encoding::UTF8) == id) {
+            return entry->slot;
+        }
+    }
+}
+
+size_t Registrations::slot(const String& id)
+{
+    return this->slot(id, Aux::hash_fnc(id.data(), id.size()));
+}
+
+size_t Registrations::slot(const String& id, uint64_t hash)
+{
+    auto* idx  = this->index.load(memory_order_acquire);
+    auto  slot = idx ? this->slot_of(idx, id, hash) : npos;
+
+    if(slot == npos) {
+        throw Exception("Class id " + id.unwrap(false) + " not registered.");
+    }
+
+    return slot;
+}
+
+InternedNames* Lib::interned_names()
+{
+    static InternedNames names;
+    return &names;
+}
+
+void InternedNames::add(const vector<String>& names)
+{
+    lock_guard<std::mutex> lock (this->mutex);
+
+    auto* idx = this->index.load(memory_order_relaxed);
+
+    for(auto& name : names) {
+        MemBlock conv(name.data(), name.size());
+
+        if(name.encoding() != Encoding::UTF8) {
+            auto size = Tools::conv_charset(Encoding::UTF8, name, this->buffer, true);
+            conv = MemBlock(this->buffer.data(), size);
+        }
+
+        auto hash = Aux::hash_fnc(conv.ptr, conv.size);
+
+        if(conv.size < 1 || this->find(conv, hash)) {
+            continue;
+        }
+
+        String str(conv);
+        if(!str.block.try_store_local()) {
+            str.block.extern_data = Aux::copy(this->heap, conv).ptr;
+        }
+
+        this->entries.push_back({ str, hash });
+        auto n = this->n_names.load(memory_order_relaxed) + 1;
+        this->n_names.store(n, memory_order_relaxed);
+
+        /* at most half of the buckets are taken */
+        if(!idx || n * 2 > idx->cap) {
+            this->grow();
+            idx = this->index.load(memory_order_relaxed);
+
+        } else {
+            this->place(idx, this->entries.back());
+        }
+    }
+}
+
+void InternedNames::grow()
+{
+    auto* current = this->index.load(memory_order_relaxed);
+    auto  cap     = current ? current->cap * 2 : First_Cap;
+
+    while(this->entries.size() * 2 > cap) {
+        cap *= 2;
+    }
+
+    auto* idx = new Index(cap);
+    this->indices.emplace_back(idx);
+
+    for(auto& entry : this->entries) {
+        this->place(idx, entry);
+    }
+
+    this->index.store(idx, memory_order_release);
+}
+
+void InternedNames::place(Index* idx, const Entry& entry)
+{
+    auto mask = idx->cap - 1;
+
+    for(auto bucket = first_bucket(entry.hash, idx->cap); ; bucket = (bucket + 1) & mask) {
+        if(!idx->buckets[bucket].load(memory_order_relaxed)) {
+            idx->buckets[bucket].store(&entry, memory_order_release);
+            return;
+        }
+    }
+}
+
+const String* InternedNames::find(const MemBlock& name, uint64_t hash) const
+{
+    auto* idx = this->index.load(memory_order_acquire);
+    if(!idx) {
+        return nullptr;
+    }
+
+    auto mask = idx->cap - 1;
+
+    for(auto bucket = first_bucket(hash, idx->cap); ; bucket = (bucket + 1) & mask) {
+        auto* entry = idx->buckets[bucket].load(memory_order_acquire);
+
+        if(!entry) {
+            return nullptr;
+        }
 
-    return exists;
+        if(entry->hash == hash && entry->name.size() == name.size &&
+           memcmp(entry->name.data(), name.ptr, name.size) == 0) {
+            return &entry->name;
+        }
+    }
 }
 
-Registrations::Make* Registrations::find (const String& id)
+void Srl::intern_names(const vector<String>& names)
 {
-    return this->table.get(id);
+    Lib::interned_names()->add(names);
 }
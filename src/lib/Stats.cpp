@@ -0,0 +1,17 @@
+#include "Srl/Stats.h"
+
+using namespace Srl;
+using namespace Lib;
+
+thread_local Stats Lib::thread_stats;
+
+Stats Srl::stats(bool reset)
+{
+    auto snapshot = thread_stats;
+
+    if(reset) {
+        thread_stats = Stats();
+    }
+
+    return snapshot;
+}
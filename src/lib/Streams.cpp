@@ -0,0 +1,223 @@
+#include "Srl/Streams.h"
+#include "Srl/Exception.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+using namespace std;
+using namespace Srl;
+using namespace Lib;
+
+void DoubleBuffer::join()
+{
+    {
+        lock_guard<mutex> guard(this->lock);
+        this->stop = true;
+    }
+    this->cond.notify_all();
+
+    if(this->helper.joinable()) {
+        this->helper.join();
+    }
+}
+
+PrefetchBuf::PrefetchBuf(istream& stream_, size_t chunk_size)
+    : DoubleBuffer(chunk_size), stream(&stream_)
+{
+    this->helper = thread(&PrefetchBuf::work, this);
+}
+
+PrefetchBuf::PrefetchBuf(int fd_, size_t chunk_size)
+    : DoubleBuffer(chunk_size), fd(fd_)
+{
+    this->helper = thread(&PrefetchBuf::work, this);
+}
+
+size_t PrefetchBuf::fetch(char* dst, size_t nbytes)
+{
+    if(this->stream) {
+        this->stream->read(dst, nbytes);
+        return this->stream->gcount();
+    }
+
+    while(true) {
+        auto n = ::read(this->fd, dst, nbytes);
+        if(n >= 0) {
+            return n;
+        }
+        if(errno != EINTR) {
+            this->failed = true;
+            return 0;
+        }
+    }
+}
+
+void PrefetchBuf::work()
+{
+    unique_lock<mutex> guard(this->lock);
+
+    while(true) {
+        this->cond.wait(guard, [this] { return this->stop || this->slot == Slot::Empty; });
+        if(this->stop) {
+            return;
+        }
+
+        /* the caller doesn't touch the back buffer until the slot is full */
+        auto& dst = this->buffers[this->back];
+        guard.unlock();
+        auto nbytes = this->fetch(dst.data(), dst.size());
+        guard.lock();
+
+        this->filled = nbytes;
+        this->slot   = nbytes > 0 ? Slot::Full : Slot::Done;
+        this->cond.notify_all();
+
+        if(nbytes == 0) {
+            return;
+        }
+    }
+}
+
+PrefetchBuf::int_type PrefetchBuf::underflow()
+{
+    if(this->gptr() < this->egptr()) {
+        return traits_type::to_int_type(*this->gptr());
+    }
+
+    unique_lock<mutex> guard(this->lock);
+    this->cond.wait(guard, [this] { return this->slot != Slot::Empty; });
+
+    if(this->slot == Slot::Done) {
+        if(this->failed) {
+            throw Exception("Unable to read from file descriptor.");
+        }
+        return traits_type::eof();
+    }
+
+    auto* front = this->buffers[this->back].data();
+    this->setg(front, front, front + this->filled);
+
+    this->back ^= 1;
+    this->slot  = Slot::Empty;
+    this->cond.notify_all();
+
+    return traits_type::to_int_type(*this->gptr());
+}
+
+WriteBehindBuf::WriteBehindBuf(ostream& stream_, size_t chunk_size)
+    : DoubleBuffer(chunk_size), stream(&stream_)
+{
+    this->setp(this->buffers[0].data(), this->buffers[0].data() + chunk_size);
+    this->helper = thread(&WriteBehindBuf::work, this);
+}
+
+WriteBehindBuf::WriteBehindBuf(int fd_, size_t chunk_size)
+    : DoubleBuffer(chunk_size), fd(fd_)
+{
+    this->setp(this->buffers[0].data(), this->buffers[0].data() + chunk_size);
+    this->helper = thread(&WriteBehindBuf::work, this);
+}
+
+WriteBehindBuf::~WriteBehindBuf()
+{
+    this->sync();
+    this->join();
+}
+
+bool WriteBehindBuf::drain(const char* src, size_t nbytes)
+{
+    if(this->stream) {
+        return (bool)this->stream->write(src, nbytes);
+    }
+
+    while(nbytes > 0) {
+        auto n = ::write(this->fd, src, nbytes);
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        src    += n;
+        nbytes -= n;
+    }
+
+    return true;
+}
+
+void WriteBehindBuf::work()
+{
+    unique_lock<mutex> guard(this->lock);
+
+    while(true) {
+        /* pending data is written out even when stopping */
+        this->cond.wait(guard, [this] { return this->stop || this->slot == Slot::Full; });
+        if(this->slot != Slot::Full) {
+            return;
+        }
+
+        auto& src = this->buffers[this->back];
+        guard.unlock();
+        auto success = this->drain(src.data(), this->filled);
+        guard.lock();
+
+        this->failed |= !success;
+        this->slot    = Slot::Empty;
+        this->cond.notify_all();
+    }
+}
+
+bool WriteBehindBuf::hand_over(unique_lock<mutex>& guard)
+{
+    this->cond.wait(guard, [this] { return this->slot == Slot::Empty; });
+    if(this->failed) {
+        return false;
+    }
+
+    size_t nbytes = this->pptr() - this->pbase();
+    if(nbytes == 0) {
+        return true;
+    }
+
+    this->back  ^= 1;
+    this->filled = nbytes;
+    this->slot   = Slot::Full;
+    this->cond.notify_all();
+
+    auto& front = this->buffers[this->back ^ 1];
+    this->setp(front.data(), front.data() + front.size());
+
+    return true;
+}
+
+WriteBehindBuf::int_type WriteBehindBuf::overflow(int_type c)
+{
+    unique_lock<mutex> guard(this->lock);
+
+    if(!this->hand_over(guard)) {
+        return traits_type::eof();
+    }
+
+    if(!traits_type::eq_int_type(c, traits_type::eof())) {
+        *this->pptr() = traits_type::to_char_type(c);
+        this->pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+int WriteBehindBuf::sync()
+{
+    unique_lock<mutex> guard(this->lock);
+
+    if(!this->hand_over(guard)) {
+        return -1;
+    }
+    this->cond.wait(guard, [this] { return this->slot == Slot::Empty; });
+
+    if(this->failed) {
+        return -1;
+    }
+
+    return this->stream && !this->stream->flush() ? -1 : 0;
+}
@@ -137,6 +137,34 @@ size_t Tools::base64_to_bytes(uint8_t* dest, size_t dest_size, const char* str,
     return get_base64_decoded_size(str, str_len);
 }
 
+namespace {
+
+    template<class T> Value read_type(const uint8_t* bytes)
+    {
+        T val;
+        memcpy(&val, bytes, sizeof(T));
+        return Value(val);
+    }
+}
+
+Value Tools::bytes_to_type(const uint8_t* bytes, Type type)
+{
+    switch(type) {
+        case Type::I8   : return read_type<int8_t>(bytes);
+        case Type::UI8  : return read_type<uint8_t>(bytes);
+        case Type::I16  : return read_type<int16_t>(bytes);
+        case Type::UI16 : return read_type<uint16_t>(bytes);
+        case Type::I32  : return read_type<int32_t>(bytes);
+        case Type::UI32 : return read_type<uint32_t>(bytes);
+        case Type::I64  : return read_type<int64_t>(bytes);
+        case Type::UI64 : return read_type<uint64_t>(bytes);
+        case Type::FP32 : return read_type<float>(bytes);
+        case Type::FP64 : return read_type<double>(bytes);
+        default :
+            throw Exception("Unable to convert bytes to type " + TpTools::get_name(type) + ".");
+    }
+}
+
 vector<uint8_t> Tools::bytes_to_hex(const uint8_t* bytes, size_t nbytes)
 {
     const char hex_lk[] {
@@ -305,6 +305,9 @@ size_t Tools::conv_charset(Encoding target_encoding, const String& str_wrap,
         return 0;
     }
 
+    SRL_COUNT(charset_conversions, 1);
+    SRL_SPAN(charset_ns);
+
     auto src_encoding = str_wrap.encoding();
 
     auto* cs_from = get_charset_string(src_encoding);
@@ -14,6 +14,7 @@ Tree& Tree::operator= (Tree&& g)
 {
     this->root_node = g.root_node;
     this->env       = move(g.env);
+    this->parts     = move(g.parts);
     if(this->env) {
         this->env->tree = this;
     }
@@ -37,11 +38,12 @@ void Tree::prologue_in(Parser& parser, Lib::In::Source& source)
     }
 
     this->env->set_input(parser, source);
+    this->env->borrow_source = false;
 
     MemBlock name; Value val;
     tie(name, val) = parser.read(this->env->in);
 
-    if(!TpTools::is_scope(val.type())) {
+    if(!TpTools::is_scope(val.type()) || val.elem_type() != Type::Null) {
         throw Exception("Unable to parse source. Data malformed.");
     }
 
@@ -51,6 +53,8 @@ void Tree::prologue_in(Parser& parser, Lib::In::Source& source)
 
 void Tree::to_source(Type type, Parser& parser, Lib::Out::Source source, const function<void()>& store_switch)
 {
+    SRL_SPAN(store_ns);
+
     if(!this->env) {
         this->create_env();
     }
@@ -70,16 +74,156 @@ void Tree::to_source(Type type, Parser& parser, Lib::Out::Source source, const f
 
 void Tree::read_source(Parser& parser, In::Source source)
 {
+    SRL_SPAN(load_ns);
+
     prologue_in(parser, source);
     this->root_node->read_source();
 }
 
 void Tree::read_source(Parser& parser, In::Source source, const function<void()>& restore_switch)
 {
+    SRL_SPAN(load_ns);
+
     prologue_in(parser, source);
     this->root_node->parsed = false;
+    this->env->borrow_source = true;
+
+    try {
+        restore_switch();
+
+    } catch(...) {
+        this->env->release_source(*this->root_node);
+        throw;
+    }
+
+    this->env->release_source(*this->root_node);
+}
+
+vector<Split> Tree::scan_array(Parser& parser, const MemBlock& source)
+{
+    In::Source in(source.ptr, source.size);
+    prologue_in(parser, in);
+
+    if(this->root_node->type() != Type::Array) {
+        throw Exception("Unable to load source in parallel. Top level scope is not an array.");
+    }
+
+    vector<Split> splits;
+    auto offsets = parser.scan_array(source);
+
+    if(!offsets.empty()) {
+        for(auto offset : offsets) {
+            splits.push_back({ offset, 0, 0 });
+        }
+        return splits;
+    }
+
+    /* parsers without a faster way read the whole array, skipping the elements */
+    auto& environment = *this->env;
+
+    while(true) {
+        splits.push_back({ (size_t)(environment.in.pointer() - source.ptr), parser.mark(), environment.type_ids_in.size() });
+
+        auto val = environment.read().second;
+
+        if(val.type() == Type::Scope_End) {
+            break;
+        }
+
+        auto depth = TpTools::is_scope(val.type()) && val.elem_type() == Type::Null ? 1 : 0;
+
+        while(depth > 0) {
+            val = environment.read().second;
+            if(TpTools::is_scope(val.type())) {
+                depth += val.elem_type() == Type::Null;
+            } else if(val.type() == Type::Scope_End) {
+                depth--;
+            }
+        }
+    }
+
+    return splits;
+}
+
+void Tree::resume_source(Parser& parser, const MemBlock& source, const Tree& scanner,
+                         const vector<Split>& splits, size_t first, size_t last)
+{
+    if(!this->env) {
+        this->create_env();
+    }
+    this->clear();
+    this->root_node = &this->env->create_node(Type::Array, Environment::EmptyString)->field;
 
-    restore_switch();
+    auto begin = splits[first].offset;
+    auto end   = splits[last].offset;
+
+    this->env->set_input(parser, In::Source(source.ptr + begin, end - begin));
+    parser.resume(*scanner.env->parser, splits[first].mark);
+
+    auto& type_ids = scanner.env->type_ids_in;
+    this->env->type_ids_in.assign(type_ids.begin(), type_ids.begin() + splits[first].type_ids);
+}
+
+void Tree::load_element()
+{
+    auto val = this->env->read().second;
+
+    if(!TpTools::is_scope(val.type()) || val.elem_type() != Type::Null) {
+        throw Exception("Unable to load source in parallel. Elements of the top level array have to be objects or arrays.");
+    }
+
+    this->root_node->store_scope(val, Environment::EmptyString);
+}
+
+bool Tree::restore_element(const function<void()>& restore_switch)
+{
+    /* the heap is reused for every element */
+    this->env->clear();
+
+    auto val = this->env->read().second;
+
+    if(!TpTools::is_scope(val.type()) || val.elem_type() != Type::Null) {
+        throw Exception("Unable to restore source in parallel. Elements of the top level array have to be objects or arrays.");
+    }
+
+    this->root_node = &this->env->create_node(val.type(), Environment::EmptyString)->field;
+    this->root_node->parsed = false;
+    this->env->borrow_source = true;
+
+    /* shared pointers may refer to pointees stored in earlier elements, which are only
+     * known to a serial restore. Errors are left to it as well. */
+    try {
+        restore_switch();
+        this->root_node->consume_scope();
+
+    } catch(...) {
+        this->env->release_source(*this->root_node);
+        if(this->env->shared_table_restore.num_entries() > 0) {
+            return false;
+        }
+        throw;
+    }
+
+    this->env->release_source(*this->root_node);
+
+    return this->env->shared_table_restore.num_entries() == 0;
+}
+
+void Tree::rebind(Tree& target)
+{
+    for(auto& link : this->root_node->nodes) {
+        link.field.rebind(target.env.get());
+    }
+}
+
+void Tree::stitch(Tree& part)
+{
+    /* elements keep living in the heap of the part they were read into */
+    for(auto& link : part.root_node->nodes) {
+        this->root_node->nodes.emplace_back(link.hash, move(link.field));
+    }
+
+    this->parts.push_back(move(part.env));
 }
 
 Node& Tree::root()
@@ -102,7 +246,7 @@ optional<Union> Tree::try_get(const String& field_name)
     return rn.try_get(field_name);
 }
 
-void Tree::clear()
+void Tree::clear(size_t keep_bytes)
 {
     if(!this->env) {
         return;
@@ -110,10 +254,99 @@ void Tree::clear()
 
     auto rtp = this->root().scope_type;
 
-    this->env->clear();
+    this->env->clear(keep_bytes);
+    this->parts.clear();
     this->root_node = &env->create_node(rtp, "")->field;
 }
 
+Tree& Tree::reuse_objects(bool reuse)
+{
+    this->get_env().reuse_objects = reuse;
+    return *this;
+}
+
+Tree& Tree::reserve_memory(size_t reserve_bytes, bool huge_pages)
+{
+    this->get_env().heap.reserve(reserve_bytes, huge_pages);
+    return *this;
+}
+
+namespace {
+
+    Heap::Stats env_heaps(const Environment& env)
+    {
+        auto stats = env.heap.stats();
+        stats += env.str_table.stats().heap;
+        stats += env.shared_table_store.stats().heap;
+        stats += env.shared_table_restore.stats().heap;
+        stats += env.type_ids_out.stats().heap;
+        stats += env.type_ids_heap.stats();
+        stats += env.out.heap_stats();
+
+        return stats;
+    }
+
+    vector<Heap::Stats> all_heaps(const MemoryStats& stats)
+    {
+        return { stats.nodes, stats.strings.heap, stats.shared_store.heap, stats.shared_restore.heap,
+                 stats.type_ids_out.heap, stats.type_ids_in, stats.output, stats.parts };
+    }
+}
+
+MemoryStats Tree::memory_stats() const
+{
+    MemoryStats stats;
+
+    if(!this->env) {
+        return stats;
+    }
+
+    auto& environment = *this->env;
+
+    stats.nodes          = environment.heap.stats();
+    stats.strings        = environment.str_table.stats();
+    stats.shared_store   = environment.shared_table_store.stats();
+    stats.shared_restore = environment.shared_table_restore.stats();
+    stats.type_ids_out   = environment.type_ids_out.stats();
+    stats.type_ids_in    = environment.type_ids_heap.stats();
+    stats.output         = environment.out.heap_stats();
+    stats.buffers        = environment.str_buffer.capacity() + environment.type_buffer.capacity();
+
+    for(auto& part : this->parts) {
+        stats.parts   += env_heaps(*part);
+        stats.buffers += part->str_buffer.capacity() + part->type_buffer.capacity();
+    }
+
+    return stats;
+}
+
+size_t MemoryStats::reserved() const
+{
+    size_t bytes = this->buffers;
+    for(auto& heap : all_heaps(*this)) {
+        bytes += heap.reserved;
+    }
+    return bytes;
+}
+
+size_t MemoryStats::used() const
+{
+    size_t bytes = this->buffers;
+    for(auto& heap : all_heaps(*this)) {
+        bytes += heap.used;
+    }
+    return bytes;
+}
+
+size_t MemoryStats::fragmented() const
+{
+    size_t bytes = 0;
+    for(auto& heap : all_heaps(*this)) {
+        bytes += heap.fragmented();
+    }
+    return bytes;
+}
+
 void Tree::create_env(Type tp)
 {
     assert(!this->env);
@@ -0,0 +1,321 @@
+#include "Tests.h"
+#include "BasicStruct.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+
+using namespace std;
+using namespace Srl;
+using namespace Tests;
+
+namespace {
+    atomic<size_t> n_allocations   { 0 };
+    atomic<size_t> bytes_allocated { 0 };
+}
+
+void* operator new(size_t size)
+{
+    n_allocations.fetch_add(1, memory_order_relaxed);
+    bytes_allocated.fetch_add(size, memory_order_relaxed);
+
+    if(auto* mem = malloc(size ? size : 1)) {
+        return mem;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* mem) noexcept
+{
+    free(mem);
+}
+
+void operator delete(void* mem, size_t) noexcept
+{
+    free(mem);
+}
+
+size_t Tests::allocated_bytes()
+{
+    return bytes_allocated.load(memory_order_relaxed);
+}
+
+size_t Tests::allocations()
+{
+    return n_allocations.load(memory_order_relaxed);
+}
+
+size_t Tests::heap_segments()
+{
+    return stats().heap_segments;
+}
+
+namespace {
+
+    struct Item {
+        int            id = 0;
+        string         label;
+        vector<double> weights;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("id", id) ("label", label) ("weights", weights);
+        }
+    };
+
+    /* a message of fixed shape, strings longer than any small string buffer */
+    struct Message {
+        uint64_t           sequence = 0;
+        string             topic;
+        vector<int>        codes;
+        vector<Item>       items;
+        map<string, int>   counters;
+        unique_ptr<Item>   extra;
+        BasicStruct        basic;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("sequence", sequence) ("topic", topic) ("codes", codes) ("items", items)
+                ("counters", counters) ("extra", extra) ("basic", basic);
+        }
+    };
+
+    Message make_message()
+    {
+        Message msg;
+        msg.sequence = 1ULL << 40;
+        msg.topic    = "market.data.updates.europe.equities";
+        msg.codes    = { 1, 2, 3, 500, 70000 };
+        for(auto i = 0; i < 8; i++) {
+            msg.items.push_back({ i, "item label number " + to_string(i), { 0.5, 1.5, i * 2.5 } });
+        }
+        msg.counters = { { "received messages", 10 }, { "dropped messages", 2 } };
+        msg.extra.reset(new Item { 99, "an extra item with a long label", { 9.5 } });
+
+        return msg;
+    }
+
+    struct PerRun {
+        double allocations;
+        double segments;
+
+        bool zero() const { return allocations == 0 && segments == 0; }
+
+        string to_string() const
+        {
+            return std::to_string(allocations) + " (" + std::to_string(segments) + " heap segments)";
+        }
+    };
+
+    /* operator new calls and Heap segments of op after warmup runs, per run */
+    PerRun allocations_per_run(const function<void()>& op)
+    {
+        for(auto i = 0; i < 3; i++) {
+            op();
+        }
+
+        const auto runs = 10;
+        auto before     = allocations();
+        auto segs       = heap_segments();
+
+        for(auto i = 0; i < runs; i++) {
+            op();
+        }
+
+        return { (double)(allocations() - before) / runs,
+                 (double)(heap_segments() - segs) / runs };
+    }
+
+    template<class TParser>
+    bool steady_state(const string& name)
+    {
+        const string SCOPE = "Steady state " + name;
+        print_log("\t" + SCOPE + "...");
+
+        try {
+            auto msg = make_message();
+            Tree tree;
+            TParser parser;
+            vector<uint8_t> source;
+
+            auto store = allocations_per_run([&] { tree.store(msg, source, parser); });
+
+            Message restored;
+            tree.reuse_objects();
+            auto restore = allocations_per_run([&] { tree.restore(restored, source, parser); });
+
+            Tree loaded;
+            auto load = allocations_per_run([&] { loaded.load_source(source, parser); });
+
+            vector<uint8_t> out;
+            auto write = allocations_per_run([&] { loaded.to_source(out, parser); });
+
+            print_log("allocations per store " + store.to_string() + ", restore " + restore.to_string()
+                      + ", load " + load.to_string() + ", write " + write.to_string() + "...");
+
+            TEST(restored.items.size() == msg.items.size() && restored.extra->label == msg.extra->label);
+            TEST(restored.counters == msg.counters);
+            msg.basic.test(restored.basic);
+            TEST(store.zero() && restore.zero() && load.zero() && write.zero());
+
+        } catch(Exception& ex) {
+            print_log(string(ex.what()) + "\n");
+            return false;
+        }
+
+        print_log("ok.\n");
+        return true;
+    }
+
+    /* a worker reusing one tree per request */
+    bool tree_clear()
+    {
+        const string SCOPE = "Clearing a tree";
+        print_log("\t" + SCOPE + "...");
+
+        try {
+            vector<Message> messages(50);
+            for(auto& msg : messages) {
+                msg = make_message();
+            }
+            auto source = Tree().store<PSrl>(messages);
+
+            Tree tree;
+            tree.load_source(source, PSrl());
+
+            const auto segments_per_load = [&](size_t keep_bytes) {
+                auto segments = heap_segments();
+                tree.clear(keep_bytes);
+                tree.load_source(source, PSrl());
+                return heap_segments() - segments;
+            };
+
+            auto kept    = segments_per_load(Lib::Heap::Keep_All);
+            auto trimmed = segments_per_load(0);
+            auto partly  = segments_per_load(source.size());
+
+            print_log("segments per load kept " + to_string(kept) + ", trimmed " + to_string(trimmed)
+                      + ", partly trimmed " + to_string(partly) + "...");
+
+#ifdef SRL_INSTRUMENT
+            TEST(kept == 0 && partly < trimmed);
+#endif
+            TEST(tree.root().num_nodes() == messages.size());
+
+        } catch(Exception& ex) {
+            print_log(string(ex.what()) + "\n");
+            return false;
+        }
+
+        print_log("ok.\n");
+        return true;
+    }
+
+    bool pooled_segments()
+    {
+        const string SCOPE = "Short-lived trees with pooled segments";
+        print_log("\t" + SCOPE + "...");
+
+        try {
+            auto msg = make_message();
+            vector<Message> messages(20);
+            for(auto& message : messages) {
+                message = make_message();
+            }
+            auto source = Tree().store<PJson>(messages);
+
+            const auto short_lived = [&] {
+                Tree().store<PSrl>(msg);
+                Tree().load_source(source, PJson());
+            };
+
+            auto unpooled = allocations_per_run(short_lived);
+            pool_segments();
+            auto pooled = allocations_per_run(short_lived);
+            pool_segments(false);
+
+            print_log("allocations per run " + unpooled.to_string() + ", pooled " + pooled.to_string() + "...");
+
+#ifdef SRL_INSTRUMENT
+            TEST(unpooled.segments > 0 && pooled.segments == 0);
+#endif
+            TEST(pooled.allocations < unpooled.allocations);
+
+        } catch(Exception& ex) {
+            pool_segments(false);
+            print_log(string(ex.what()) + "\n");
+            return false;
+        }
+
+        print_log("ok.\n");
+        return true;
+    }
+
+    struct Pair {
+        int first = 1, second = 2;
+
+        void srl_resolve(Context& ctx)
+        {
+            ctx ("first", first) ("second", second);
+        }
+    };
+
+    /* freed list links are taken up again, a mutated tree stops growing */
+    bool tree_churn()
+    {
+        const string SCOPE = "Churn in a long-lived tree";
+        print_log("\t" + SCOPE + "...");
+
+        try {
+            Tree tree;
+            auto& root = tree.root();
+
+            const auto churn = [&](size_t cycles) {
+                for(auto i = 0U; i < cycles; i++) {
+                    root.insert("value", (int)i);
+                    root.insert("pair", Pair());
+                    root.remove_value((size_t)0);
+                    root.remove_node((size_t)0);
+                }
+            };
+
+            for(auto i = 0; i < 1000; i++) {
+                root.insert("value", i);
+                root.insert("pair", Pair());
+            }
+            churn(1000);
+
+            auto segments = heap_segments();
+            auto churned  = allocations_per_run([&] { churn(10000); });
+
+            print_log("allocations per 10000 cycles " + churned.to_string() + "...");
+
+            TEST(churned.zero() && heap_segments() == segments);
+            TEST(root.num_values() == 1000 && root.num_nodes() == 1000);
+
+        } catch(Exception& ex) {
+            print_log(string(ex.what()) + "\n");
+            return false;
+        }
+
+        print_log("ok.\n");
+        return true;
+    }
+}
+
+bool Tests::test_allocations()
+{
+    print_log("\nTest allocations\n");
+
+    bool success = steady_state<PSrl>("Srl");
+    success &= steady_state<PJson>("Json");
+    success &= steady_state<PMsgPack>("MsgPack");
+    success &= tree_clear();
+    success &= pooled_segments();
+    success &= tree_churn();
+
+    return success;
+}
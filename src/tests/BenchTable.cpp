@@ -6,6 +6,7 @@
 #include <memory>
 #include <unistd.h>
 #include <map>
+#include <thread>
 
 using namespace std;
 using namespace Srl;
@@ -35,6 +36,26 @@ struct BStruct {
 
 };
 
+/* calls the parser through the virtual functions for every token, as any
+ * parser without a pipeline of its own */
+struct Virtual : Parser {
+
+    Virtual(Parser& parser_) : parser(parser_) { }
+
+    Parser& parser;
+
+    Format get_format() const override  { return parser.get_format(); }
+    bool   packs_arrays() const override { return parser.packs_arrays(); }
+
+    void write(const Value& value, const Lib::MemBlock& name, Lib::Out& out) override
+    {
+        parser.write(value, name, out);
+    }
+
+    pair<Lib::MemBlock, Value> read(Lib::In& source) override { return parser.read(source); }
+    void clear() override { parser.clear(); }
+};
+
 void measure(const function<void(void)>& fnc, const string& msg,
              const function<void(void)>& rep = [] { },
              int fac = Tests::Benchmark_Iterations)
@@ -93,6 +114,10 @@ void run_bench(Tree& tree, T&& parser, const string& name, Tail&&... tail)
         measure([&](){ tree.to_source(source, parser); },   "\tparse out  ms: ");
         measure([&](){ reuse.load_source(source, parser); }, "\tparse in   ms: ");
 
+        Virtual dynamic(parser);
+        measure([&](){ tree.to_source(source, dynamic); },   "\tparse out / virtual ms: ");
+        measure([&](){ reuse.load_source(source, dynamic); }, "\tparse in  / virtual ms: ");
+
         measure([&](){ ofstream fs("File"); tree.to_source(fs, parser); },        "\twrite file ms: ", []{ }, 1);
         measure([&](){ ifstream fsi("File"); reuse.load_source(fsi, parser); },    "\tread file  ms: ", []{ }, 1);
 
@@ -106,7 +131,7 @@ void run_bench(Tree& tree, T&& parser, const string& name, Tail&&... tail)
             while(true) {
                 auto seg = parser.read(src);
                 if(TpTools::is_scope(seg.second.type())) {
-                    depth++;
+                    depth += seg.second.elem_type() == Type::Null;
                     continue;
                 }
                 if(seg.second.type() == Type::Scope_End) {
@@ -127,6 +152,31 @@ void run_bench(Tree& tree, T&& parser, const string& name, Tail&&... tail)
     run_bench(tree, tail...);
 }
 
+void run_batch_bench(const map<string, BStruct>& data)
+{
+    try {
+        vector<BStruct> objects;
+        for(auto& entry : data) {
+            objects.push_back(entry.second);
+        }
+
+        auto cores = max((size_t)thread::hardware_concurrency(), (size_t)1);
+
+        for(size_t threads = 1; threads <= cores; threads = threads < cores ? min(threads * 2, cores) : cores + 1) {
+            print_log("\nBenching batches on " + to_string(threads) + " threads...\n");
+
+            vector<vector<uint8_t>> sources;
+            measure([&](){ sources = store_batch<PSrl>(objects, threads); },            "\tStore Srl    ms: ");
+            measure([&](){ restore_batch<PSrl>(sources, objects, threads); },         "\tRestore Srl  ms: ");
+            measure([&](){ sources = store_batch<PJson>(objects, threads); },           "\tStore Json   ms: ");
+            measure([&](){ restore_batch<PJson>(sources, objects, threads); },        "\tRestore Json ms: ");
+        }
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+    }
+}
+
 void Tests::run_benches()
 {
     Verbose = true;
@@ -155,4 +205,6 @@ void Tests::run_benches()
         PJson(false), "PJson w/ space"
     );
 
+    run_batch_bench(data);
+
 }
@@ -0,0 +1,238 @@
+#include "Tests.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+using namespace std;
+using namespace Srl;
+using namespace Tests;
+
+namespace {
+
+    /* Each case builds its input for size n and returns the operation to measure. The operation is
+     * timed at n and at Growth_Factor * n, linear growth may be off by the tolerance due to
+     * caches and noise, quadratic growth is Growth_Factor times worse. */
+    const size_t Growth_Factor = 8;
+    const double Tolerance     = 2.0;
+
+    struct Case {
+        function<void()> operation;
+        /* optional linear pass over the same input, operation is measured relative to it
+         * to cancel out inputs outgrowing the caches */
+        function<void()> reference;
+    };
+
+    typedef function<Case(size_t n)> Setup;
+
+    struct Sample {
+        double time;
+        size_t bytes;
+    };
+
+    Sample measure(const function<void()>& operation)
+    {
+        /* the fastest of a few runs is the least noisy one */
+        auto best = numeric_limits<double>::max();
+        size_t bytes = 0;
+
+        for(auto i = 0; i < 5; i++) {
+            auto allocated = allocated_bytes();
+            auto start     = chrono::steady_clock::now();
+
+            operation();
+
+            auto end = chrono::steady_clock::now();
+            bytes = allocated_bytes() - allocated;
+            best  = min(best, chrono::duration<double, micro>(end - start).count());
+        }
+
+        return { best, bytes };
+    }
+
+    bool grows_linearly(const string& name, const Setup& setup, size_t n, bool expect_failure = false)
+    {
+        print_log("\t" + name + "...");
+
+        auto small_case = setup(n);
+        auto large_case = setup(n * Growth_Factor);
+
+        auto small = measure(small_case.operation);
+        auto large = measure(large_case.operation);
+
+        auto time_ratio = large.time / max(small.time, 1.0);
+        if(small_case.reference) {
+            auto small_ref = measure(small_case.reference);
+            auto large_ref = measure(large_case.reference);
+            time_ratio *= Growth_Factor * max(small_ref.time, 1.0) / max(large_ref.time, 1.0);
+        }
+        auto mem_ratio  = (double)large.bytes / max<size_t>(small.bytes, 1);
+        auto limit      = Growth_Factor * Tolerance;
+
+        auto linear = time_ratio <= limit && mem_ratio <= limit;
+        auto ratios = "time x" + to_string(time_ratio) + ", memory x" + to_string(mem_ratio)
+                    + " for x" + to_string(Growth_Factor) + " input";
+
+        if(linear) {
+            print_log("ok. (" + ratios + ")\n");
+            return true;
+        }
+
+        if(expect_failure) {
+            print_log("superlinear, expected. (" + ratios + ")\n");
+            return true;
+        }
+
+        print_log("superlinear. (" + ratios + ")\n");
+        return false;
+    }
+
+    /* names whose unseeded hashes share their lowest bits, as an attacker would compute them,
+     * without the seed of the string table they end up in the same bucket of tables with up to 2 ^ bits buckets */
+    vector<string> colliding_names(size_t n, size_t bits)
+    {
+        vector<string> names;
+        auto mask = (1ULL << bits) - 1;
+
+        for(auto i = 0ULL; names.size() < n; i++) {
+            auto name = "f" + to_string(i);
+            auto hash = Lib::Aux::hash_fnc((const uint8_t*)name.data(), name.size());
+            if(((hash ^ hash >> 32) & mask) == 0) {
+                names.push_back(name);
+            }
+        }
+
+        return names;
+    }
+
+    string json_object(const vector<string>& names)
+    {
+        string json = "{";
+        for(auto i = 0U; i < names.size(); i++) {
+            json += (i > 0 ? ",\"" : "\"") + names[i] + "\":" + to_string(i);
+        }
+        return json + "}";
+    }
+
+    struct ManyFields {
+        vector<string> names;
+        vector<int>    values;
+        /* field order while restoring, stored in index order */
+        vector<size_t> order;
+
+        void srl_resolve(Context& ctx)
+        {
+            auto n = this->names.size();
+            for(auto i = 0U; i < n; i++) {
+                auto idx = this->order.empty() ? i : this->order[i];
+                ctx (String(this->names[idx]), this->values[idx]);
+            }
+        }
+    };
+
+    Setup colliding_field_names()
+    {
+        return [](size_t n) {
+            auto json = make_shared<string>(json_object(colliding_names(n, 12)));
+            return Case { [json] { Tree().load_source(*json, PJson()); }, nullptr };
+        };
+    }
+
+    /* fields restored in reversed order or shuffled with a fixed seed */
+    template<class TParser>
+    Setup reordered_restore(bool shuffled)
+    {
+        return [shuffled](size_t n) {
+            auto fields = make_shared<ManyFields>();
+            for(auto i = 0U; i < n; i++) {
+                fields->names.push_back("field" + to_string(i));
+                fields->values.push_back(i);
+            }
+            auto source = make_shared<vector<uint8_t>>(Tree().store<TParser>(*fields));
+
+            for(auto i = 0U; i < n; i++) {
+                fields->order.push_back(n - 1 - i);
+            }
+            if(shuffled) {
+                shuffle(fields->order.begin(), fields->order.end(), mt19937(n));
+            }
+
+            return Case { [fields, source] { Tree().restore(*fields, *source, TParser()); }, nullptr };
+        };
+    }
+
+    Setup indexed_values()
+    {
+        return [](size_t n) {
+            auto tree = make_shared<Tree>();
+            tree->load_object(vector<string>(n, "element"));
+
+            auto* root = &tree->root();
+
+            return Case {
+                [tree, root] {
+                    for(auto i = 0U; i < root->num_values(); i++) {
+                        root->value(i);
+                    }
+                },
+                [tree, root] { root->foreach_value([](Value&) { }); }
+            };
+        };
+    }
+
+    Setup indexed_nodes()
+    {
+        return [](size_t n) {
+            auto tree = make_shared<Tree>();
+            tree->load_object(vector<vector<int>>(n, vector<int> { 1 }));
+
+            auto* root = &tree->root();
+
+            return Case {
+                [tree, root] {
+                    for(auto i = 0U; i < root->num_nodes(); i++) {
+                        root->get(i);
+                    }
+                },
+                [tree, root] { root->foreach_node([](Node&) { }); }
+            };
+        };
+    }
+
+    /* n nested arrays, 64 times */
+    Setup deep_nesting()
+    {
+        return [](size_t depth) {
+            string chain = string(depth, '[') + "1" + string(depth, ']');
+            auto json = make_shared<string>("[" + chain);
+            for(auto i = 1; i < 64; i++) {
+                *json += "," + chain;
+            }
+            *json += "]";
+
+            return Case { [json] {
+                Tree tree;
+                tree.load_source(*json, PJson());
+                tree.to_source<PSrl>();
+            }, nullptr };
+        };
+    }
+}
+
+bool Tests::test_complexity()
+{
+    print_log("\nTest complexity\n");
+
+    bool success = true;
+
+    success &= grows_linearly("Colliding field names", colliding_field_names(), 500);
+    success &= grows_linearly("Restore in reversed field order, Srl", reordered_restore<PSrl>(false), 1000);
+    success &= grows_linearly("Restore in reversed field order, Json", reordered_restore<PJson>(false), 1000);
+    success &= grows_linearly("Restore in shuffled field order, Srl", reordered_restore<PSrl>(true), 1000);
+    success &= grows_linearly("Restore in shuffled field order, Json", reordered_restore<PJson>(true), 1000);
+    success &= grows_linearly("Access values by index", indexed_values(), 10000);
+    success &= grows_linearly("Access nodes by index", indexed_nodes(), 10000);
+    success &= grows_linearly("Nesting up to max depth", deep_nesting(), 16);
+
+    return success;
+}
@@ -3,6 +3,9 @@
 #include "Tests.h"
 #include "BasicStruct.h"
 
+#include <cstring>
+#include <set>
+
 using namespace std;
 using namespace Srl;
 using namespace Tests;
@@ -156,6 +159,70 @@ bool malicious_input()
         print_log("ok. -> " + string(ex.what()) + "\n");
     }
 
+    try {
+        print_log("\tColliding field names..");
+        /* names sharing the lowest bits of their public unseeded hash, one bucket without a seed */
+        string source_colliding = "{";
+        auto n_names = 0U;
+        for(auto i = 0ULL; n_names < 500; i++) {
+            auto name = "f" + to_string(i);
+            auto hash = Lib::Aux::hash_fnc((const uint8_t*)name.data(), name.size());
+            if(((hash ^ hash >> 32) & 0xFFF) == 0) {
+                source_colliding += (n_names++ > 0 ? ",\"" : "\"") + name + "\":0";
+            }
+        }
+        source_colliding += "}";
+
+        Srl::Tree tree_col;
+        tree_col.load_source(source_colliding, Srl::PJson());
+        auto chain = tree_col.memory_stats().strings.longest_chain;
+
+        if(tree_col.root().num_values() == n_names && chain < 16) {
+            print_log("ok. -> longest chain " + to_string(chain) + "\n");
+        } else {
+            success = false;
+            print_log("failed. -> longest chain " + to_string(chain) + "\n");
+        }
+
+    } catch(Exception& ex) {
+        success = false;
+        print_log("failed. -> " + string(ex.what()) + "\n");
+    }
+
+    try {
+        print_log("\tNames cancelling the seed..");
+        /* 16 byte names whose words read into the final multiply equal its constant, without
+         * the seed in that multiply they hash alike for every seed */
+        const auto p1 = Lib::Aux::Wy::P1;
+        const auto n_names = 1000U;
+
+        Srl::Tree tree_names;
+        set<uint64_t> hashes;
+        for(auto i = 0U; i < n_names; i++) {
+            uint32_t words[] = { (uint32_t)(p1 >> 32), i, (uint32_t)p1, i * 7 };
+            uint8_t name[16];
+            memcpy(name, words, sizeof(name));
+
+            hashes.insert(Lib::Aux::hash_seeded(name, sizeof(name)));
+            tree_names.root().insert(String(name, sizeof(name), Encoding::UTF8), i);
+        }
+
+        Srl::Tree tree_col;
+        tree_col.load_source(tree_names.to_source<PMsgPack>(), PMsgPack());
+        auto chain = tree_col.memory_stats().strings.longest_chain;
+
+        if(hashes.size() == n_names && tree_col.root().num_values() == n_names && chain < 16) {
+            print_log("ok. -> longest chain " + to_string(chain) + "\n");
+        } else {
+            success = false;
+            print_log("failed. -> " + to_string(hashes.size()) + " hashes, longest chain " + to_string(chain) + "\n");
+        }
+
+    } catch(Exception& ex) {
+        success = false;
+        print_log("failed. -> " + string(ex.what()) + "\n");
+    }
+
     string source_nested = "";
     for(auto i = 0U; i < 1024 * 10; i++) {
         source_nested += "{\"n\":{";
@@ -1,7 +1,15 @@
 #include "Tests.h"
 #include "BasicStruct.h"
+#include <atomic>
 #include <list>
 #include <memory>
+#include <map>
+#include <memory_resource>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
 
 using namespace std;
 using namespace Srl;
@@ -285,6 +293,86 @@ struct TestClass {
     }
 };
 
+/* fields named like type ids aren't type ids */
+struct FakeTypeId {
+    int srl_type_id = 0;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("srl_type_id", srl_type_id);
+    }
+};
+
+struct FakeTypeName {
+    string srl_type_id;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("srl_type_id", srl_type_id);
+    }
+};
+
+struct FakeTypeIds {
+    vector<FakeTypeId>   ids;
+    vector<FakeTypeName> names;
+    unique_ptr<Base>     base;
+
+    SRL_FIELDS(FakeTypeIds, ids, names, base)
+};
+
+template<class TParser>
+bool type_ids_interned(bool interned)
+{
+    vector<unique_ptr<Base>> objects;
+    for(auto i = 0; i < 100; i++) {
+        objects.emplace_back(i % 2 ? (Base*)new DerivedA(i) : new DerivedB(i));
+    }
+
+    auto source = Tree().store<TParser>(objects);
+    auto text   = string(source.begin(), source.end());
+
+    /* each id string is written once, later objects refer to it by index */
+    if(text.find("DerivedA") == string::npos || (text.find("DerivedA") == text.rfind("DerivedA")) != interned) {
+        return false;
+    }
+
+    auto restored = Tree().restore<vector<unique_ptr<Base>>, TParser>(source);
+    for(auto i = 0; i < 100; i++) {
+        if(restored[i]->get() != i || restored[i]->srl_type_id().name() != objects[i]->srl_type_id().name()) {
+            return false;
+        }
+    }
+
+    /* loaded documents keep the ids as strings */
+    Tree tree;
+    tree.load_source(source, TParser());
+
+    if(tree.to_source<PJson>() != Tree().store<PJson>(objects) || tree.to_source<TParser>() != source) {
+        return false;
+    }
+
+    FakeTypeIds fakes;
+    for(auto i = 0; i < 10; i++) {
+        fakes.ids.push_back({ 100 + i });
+        fakes.names.push_back({ "DerivedA" });
+    }
+    fakes.base.reset(new DerivedA(7));
+
+    source = Tree().store<TParser>(fakes);
+    auto restored_fakes = Tree().restore<FakeTypeIds, TParser>(source);
+
+    for(auto i = 0U; i < fakes.ids.size(); i++) {
+        if(restored_fakes.ids[i].srl_type_id != fakes.ids[i].srl_type_id ||
+           restored_fakes.names[i].srl_type_id != fakes.names[i].srl_type_id) {
+            return false;
+        }
+    }
+
+    tree.load_source(source, TParser());
+
+    return restored_fakes.base->get() == 7 && tree.to_source<PJson>() == Tree().store<PJson>(fakes);
+}
+
 bool test_polymorphic_classes()
 {
     const string SCOPE = "Serializing polymorphic classes";
@@ -300,6 +388,9 @@ bool test_polymorphic_classes()
         TEST(cl.one->get() == 12);
         TEST(cl.two->get() == 6);
 
+        TEST(type_ids_interned<PSrl>(true));
+        TEST(type_ids_interned<PMsgPack>(false));
+
     } catch(Exception& ex) {
         print_log(string(ex.what()) + "\n");
         return false;
@@ -463,6 +554,1224 @@ bool test_pointer_serializing()
     return true;
 }
 
+struct OrderA {
+    int         a = 1;
+    string      b = "b";
+    vector<int> c = { 1, 2, 3 };
+    double      d = 4.5;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("a", a) ("b", b) ("c", c) ("d", d);
+    }
+};
+
+struct OrderB {
+    int         a = 0;
+    string      b;
+    vector<int> c;
+    double      d = 0.0;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("d", d) ("b", b) ("a", a) ("c", c);
+    }
+};
+
+struct OrderFields {
+    int         a = 0;
+    string      b;
+    vector<int> c;
+    double      d = 0.0;
+
+    SRL_FIELDS(OrderFields, d, c, a, b)
+};
+
+struct OrderNested {
+    OrderFields f;
+    OrderB      e;
+    int         x = 0;
+
+    SRL_FIELDS(OrderNested, x, e, f)
+};
+
+struct OrderFieldsKeys {
+    int         a = 0;
+    string      b;
+    vector<int> c;
+    double      d = 0.0;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx (Key("b"), b) (Key("d"), d) (Key("a"), a) (Key("c"), c);
+    }
+};
+
+template<class TParser, class T>
+bool restore_in_order(const string& SCOPE)
+{
+    OrderA stored;
+    stored.a = 7; stored.b = "seven"; stored.c = { 7, 7 }; stored.d = 7.5;
+
+    auto source = Tree().store<TParser>(stored);
+    auto restored = Tree().restore<T, TParser>(source);
+
+    TEST(restored.a == stored.a);
+    TEST(restored.b == stored.b);
+    TEST(restored.c == stored.c);
+    TEST(restored.d == stored.d);
+
+    return true;
+}
+
+bool test_field_order()
+{
+    const string SCOPE = "Restoring fields in and out of order";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        restore_in_order<PSrl, OrderA>(SCOPE);
+        restore_in_order<PSrl, OrderB>(SCOPE);
+        restore_in_order<PJson, OrderA>(SCOPE);
+        restore_in_order<PJson, OrderB>(SCOPE);
+        restore_in_order<PMsgPack, OrderA>(SCOPE);
+        restore_in_order<PMsgPack, OrderB>(SCOPE);
+
+        restore_in_order<PSrl, OrderFields>(SCOPE);
+        restore_in_order<PJson, OrderFields>(SCOPE);
+        restore_in_order<PMsgPack, OrderFields>(SCOPE);
+        restore_in_order<PJson, OrderFieldsKeys>(SCOPE);
+        restore_in_order<PSrl, OrderFieldsKeys>(SCOPE);
+
+        OrderNested nested;
+        nested.f.a = 3; nested.f.b = "three"; nested.f.c = { 3 }; nested.f.d = 3.5;
+        nested.e.a = 4; nested.e.b = "four"; nested.x = 5;
+
+        auto tree = Tree();
+        auto rslt = tree.restore<OrderNested, PSrl>(tree.store<PSrl>(nested));
+        TEST(rslt.f.a == 3 && rslt.f.b == "three" && rslt.f.c == nested.f.c && rslt.f.d == 3.5);
+        TEST(rslt.e.a == 4 && rslt.e.b == "four" && rslt.x == 5);
+
+        tree.load_object(nested);
+        auto from_tree = tree.root().unwrap<OrderNested>();
+        TEST(from_tree.e.b == "four" && from_tree.f.b == "three" && from_tree.x == 5);
+
+        /* missing fields still raise an error */
+        bool thrown = false;
+        try {
+            Tree().restore<OrderNested, PJson>(Tree().store<PJson>(OrderA()));
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct Numeric {
+    vector<double>  fp;
+    vector<int32_t> ints;
+    uint16_t        small[3] = { 1, 2, 3 };
+    list<int>       lst;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("fp", fp) ("ints", ints) ("small", small) ("lst", lst);
+    }
+};
+
+template<class TParser>
+bool restore_packed(const string& SCOPE, const Numeric& stored)
+{
+    auto source   = Tree().store<TParser>(stored);
+    auto restored = Tree().restore<Numeric, TParser>(source);
+
+    TEST(restored.fp == stored.fp);
+    TEST(restored.ints == stored.ints);
+    TEST(memcmp(restored.small, stored.small, sizeof(stored.small)) == 0);
+    TEST(restored.lst == stored.lst);
+
+    /* element types may differ from the packed type */
+    Tree tree;
+    tree.load_source(source, TParser());
+    auto wide = tree.root().unwrap_field<vector<int64_t>>(String("ints"));
+    auto fps  = tree.root().unwrap_field<list<double>>(String("ints"));
+
+    TEST(wide.size() == stored.ints.size() && wide[2] == stored.ints[2]);
+    TEST(fps.size() == stored.ints.size() && fps.back() == stored.ints.back());
+
+    return true;
+}
+
+bool test_packed_arrays()
+{
+    const string SCOPE = "Packed scalar arrays";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        Numeric num;
+        num.fp   = { 1.5, -2.25, 1e300, 0.1 };
+        num.ints = { -1, 0, 2147483647, 42 };
+        num.lst  = { 4, 5 };
+
+        restore_packed<PSrl>(SCOPE, num);
+        restore_packed<PJson>(SCOPE, num);
+        restore_packed<PMsgPack>(SCOPE, num);
+
+        Tree tree;
+        tree.load_object(num);
+
+        auto& fp = tree.root().node("fp");
+        TEST(fp.is_packed() && fp.num_values() == 4);
+        TEST(fp.element(2).unwrap<double>() == 1e300);
+        TEST(tree.root().node("small").is_packed());
+        TEST(!tree.root().node("lst").is_packed());
+
+        auto from_tree = tree.root().unwrap<Numeric>();
+        TEST(from_tree.fp == num.fp && from_tree.ints == num.ints);
+
+        /* the dom doesn't change the encoding */
+        auto json = tree.to_source<PJson>();
+        TEST(json == Tree().store<PJson>(num));
+
+        auto srl = tree.to_source<PSrl>();
+        TEST(srl == Tree().store<PSrl>(num));
+
+        tree.load_source(srl, PSrl());
+        TEST(tree.root().node("ints").is_packed());
+
+        /* access by reference unpacks */
+        auto& ints = tree.root().node("ints");
+        TEST(ints.value(3).unwrap<int>() == 42);
+        TEST(!ints.is_packed() && ints.num_values() == 4);
+
+        ints.insert(7);
+        TEST(ints.num_values() == 5 && ints.element(4).unwrap<int>() == 7);
+
+        bool thrown = false;
+        try {
+            tree.root().node("fp").element(4);
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct Message {
+    string              text;
+    vector<double>      values;
+    vector<OrderA>      items;
+    unique_ptr<OrderA>  single;
+    TestClass           poly;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("text", text) ("values", values) ("items", items) ("single", single) ("poly", poly);
+    }
+};
+
+bool test_reuse_objects()
+{
+    const string SCOPE = "Restoring into existing objects";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        Message big;
+        big.text   = string(100, 'x');
+        big.values = vector<double>(64, 1.5);
+        big.items.resize(4);
+        big.items[3].b = string(50, 'b');
+        big.single.reset(new OrderA());
+        big.poly.one.reset(new DerivedA(3));
+        big.poly.two.reset(new DerivedB(4));
+
+        Message small;
+        small.text   = "short";
+        small.values = { 2.5 };
+        small.items.resize(2);
+        small.items[1].a = 9;
+        small.single.reset(new OrderA());
+        small.single->d = 4.5;
+        small.poly.one.reset(new DerivedA(5));
+        small.poly.two.reset(new DerivedA(6));
+
+        PSrl parser;
+        auto big_src   = Tree().store(big, parser);
+        auto small_src = Tree().store(small, parser);
+
+        Tree tree;
+        tree.reuse_objects();
+
+        Message msg;
+        tree.restore(msg, big_src, parser);
+
+        auto* text_mem   = msg.text.data();
+        auto* values_mem = msg.values.data();
+        auto* items_mem  = msg.items.data();
+        auto* single_ptr = msg.single.get();
+        auto* one_ptr    = msg.poly.one.get();
+
+        tree.restore(msg, small_src, parser);
+
+        TEST(msg.text == "short" && msg.values == small.values);
+        TEST(msg.items.size() == 2 && msg.items[1].a == 9);
+        TEST(msg.single->d == 4.5 && msg.poly.one->get() == 5 && msg.poly.two->get() == 6);
+        TEST(strcmp(msg.poly.two->srl_type_id().name(), "DerivedA") == 0);
+
+        /* same type, same memory */
+        TEST(msg.text.data() == text_mem && msg.values.data() == values_mem);
+        TEST(msg.items.data() == items_mem && msg.single.get() == single_ptr);
+        TEST(msg.poly.one.get() == one_ptr);
+
+        tree.restore(msg, big_src, parser);
+
+        TEST(msg.text == big.text && msg.values == big.values);
+        TEST(msg.items.size() == 4 && msg.items[3].b == big.items[3].b);
+        TEST(msg.poly.two->get() == 4 && msg.values.data() == values_mem);
+
+        /* without reuse restored objects are replaced */
+        tree.reuse_objects(false);
+        tree.restore(msg, big_src, parser);
+        TEST(msg.single.get() != single_ptr && msg.single->d == big.single->d);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct PmrMessage {
+    using allocator_type = pmr::polymorphic_allocator<char>;
+
+    PmrMessage(const allocator_type& alloc = { })
+        : name(alloc), values(alloc), tags(alloc), index(alloc) { }
+
+    pmr::string                 name;
+    pmr::vector<double>         values;
+    pmr::vector<pmr::string>    tags;
+    pmr::map<pmr::string, int>  index;
+    shared_ptr<OrderA>          shared;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("name", name) ("values", values) ("tags", tags) ("index", index) ("shared", shared);
+    }
+};
+
+struct PmrNote {
+    pmr::string s;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("s", s);
+    }
+};
+
+/* pmr members of a plain struct, constructed with the default resource */
+struct PmrRequest {
+    pmr::vector<int>         v;
+    pmr::string              s;
+    pmr::vector<pmr::string> vs;
+    unique_ptr<PmrNote>      next;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("v", v) ("s", s) ("vs", vs) ("next", next);
+    }
+};
+
+bool test_pmr_restore()
+{
+    const string SCOPE = "Restoring into memory resources";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        PmrMessage msg;
+        msg.name   = string(40, 'n');
+        msg.values = { 1.0, 2.0, 3.0 };
+        msg.tags   = { pmr::string(30, 't'), pmr::string(20, 'u') };
+        msg.index  = { { pmr::string(25, 'k'), 1 } };
+        msg.shared = make_shared<OrderA>();
+        msg.shared->b = string(30, 's');
+
+        auto source = Tree().store<PJson>(msg);
+
+        vector<uint8_t> buffer(1 << 16);
+        pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), pmr::null_memory_resource());
+
+        const auto in_buffer = [&buffer](const void* p) {
+            return p >= buffer.data() && p < buffer.data() + buffer.size();
+        };
+
+        auto restored = Tree().restore<PmrMessage, PJson>(source, &resource);
+
+        TEST(restored.name == msg.name && restored.values == msg.values);
+        TEST(restored.tags == msg.tags && restored.index == msg.index);
+        TEST(restored.shared->b == msg.shared->b);
+
+        TEST(restored.name.get_allocator().resource() == &resource);
+        TEST(in_buffer(restored.name.data()) && in_buffer(restored.values.data()));
+        TEST(in_buffer(restored.tags[0].data()) && in_buffer(restored.index.begin()->first.data()));
+        TEST(in_buffer(restored.shared.get()));
+
+        PmrRequest request;
+        request.v    = { 1, 2, 3 };
+        request.s    = string(40, 's');
+        request.vs   = { pmr::string(30, 'v') };
+        request.next.reset(new PmrNote());
+        request.next->s = string(50, 'n');
+
+        PmrRequest req_restored;
+        Tree().restore(req_restored, Tree().store<PMsgPack>(request), &resource, PMsgPack());
+
+        TEST(req_restored.v == request.v && req_restored.s == request.s && req_restored.vs == request.vs);
+        TEST(req_restored.v.get_allocator().resource() == &resource && req_restored.s.get_allocator().resource() == &resource);
+        TEST(req_restored.vs.get_allocator().resource() == &resource && req_restored.vs[0].get_allocator().resource() == &resource);
+        TEST(in_buffer(req_restored.s.data()) && in_buffer(req_restored.vs[0].data()));
+        TEST(req_restored.next->s == request.next->s && in_buffer(req_restored.next->s.data()));
+
+        /* without a resource objects come from the default heap */
+        auto plain = Tree().restore<PmrMessage, PJson>(source);
+        TEST(!in_buffer(plain.name.data()) && !in_buffer(plain.shared.get()));
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct Views {
+    string_view         name;
+    vector<string_view> tags;
+    int                 id = 0;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("name", name) ("tags", tags) ("id", id);
+    }
+};
+
+struct ViewsReversed {
+    int                 id = 0;
+    vector<string_view> tags;
+    string_view         name;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("id", id) ("tags", tags) ("name", name);
+    }
+};
+
+struct OnlyId {
+    int id = 0;
+
+    void srl_resolve(Context& ctx)
+    {
+        ctx ("id", id);
+    }
+};
+
+template<class TParser, class TViews>
+bool views_borrow(const vector<uint8_t>& source)
+{
+    const auto in_source = [&source](const string_view& str) {
+        return (const uint8_t*)str.data() >= source.data()
+            && (const uint8_t*)str.data() + str.size() <= source.data() + source.size();
+    };
+
+    auto views = Tree().restore<TViews, TParser>(source);
+
+    return views.name == "name" && views.tags.size() == 2 && views.tags[1] == "tag1" && views.id == 5
+        && in_source(views.name) && in_source(views.tags[0]) && in_source(views.tags[1]);
+}
+
+template<class TParser>
+bool views_refuse(const vector<uint8_t>& source)
+{
+    try {
+        Tree().restore<Views, TParser>(source);
+        return false;
+
+    } catch(Exception&) {
+        return true;
+    }
+}
+
+bool test_string_views()
+{
+    const string SCOPE = "Restoring string views";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        Views views;
+        views.name = "name";
+        views.tags = { "tag0", "tag1" };
+        views.id   = 5;
+
+        auto srl  = Tree().store<PSrl>(views);
+        auto msgp = Tree().store<PMsgPack>(views);
+        auto json = Tree().store<PJson>(views);
+
+        TEST((views_borrow<PSrl, Views>(srl)));
+        TEST((views_borrow<PMsgPack, Views>(msgp)));
+        TEST((views_borrow<PJson, Views>(json)));
+
+        /* fields restored out of order are buffered without copying */
+        TEST((views_borrow<PSrl, ViewsReversed>(srl)));
+        TEST((views_borrow<PJson, ViewsReversed>(json)));
+
+        /* escaped json strings can't be borrowed */
+        views.name = "na\"me";
+        TEST(views_refuse<PJson>(Tree().store<PJson>(views)));
+
+        /* neither can strings from streamed input */
+        bool refused = false;
+        try {
+            stringstream strm(string(srl.begin(), srl.end()));
+            Tree().restore<Views, PSrl>(strm);
+
+        } catch(Exception&) {
+            refused = true;
+        }
+        TEST(refused);
+
+        /* fields left in the tree by a restore don't outlive the source */
+        Tree restored;
+        OnlyId only_id;
+        {
+            auto copy = srl;
+            restored.restore(only_id, copy, PSrl());
+        }
+        TEST(only_id.id == 5 && restored.root().value("name").unwrap<string>() == "name");
+
+        /* views are copied into the document when loading it */
+        Tree tree;
+        tree.load_source(srl, PSrl());
+        auto* data = tree.root().value("name").data();
+        TEST(data < srl.data() || data >= srl.data() + srl.size());
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_batches()
+{
+    const string SCOPE = "Batch serialization";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        vector<OrderA> objects(1000);
+        for(auto i = 0U; i < objects.size(); i++) {
+            objects[i].a = i;
+            objects[i].b = to_string(i);
+        }
+
+        auto sources = store_batch<PSrl>(objects, 4);
+        TEST(sources.size() == objects.size());
+        TEST(sources[10] == Tree().store<PSrl>(objects[10]));
+
+        auto restored = restore_batch<OrderB, PSrl>(sources, 4);
+        TEST(restored.size() == objects.size());
+        for(auto i = 0U; i < objects.size(); i++) {
+            TEST(restored[i].a == (int)i && restored[i].b == to_string(i));
+        }
+
+        vector<uint8_t> framed;
+        store_batch_framed<PJson>(objects, framed, 3);
+
+        auto unframed = restore_batch_framed<OrderA, PJson>(framed.data(), framed.size(), 3);
+        TEST(unframed.size() == objects.size() && unframed.back().b == objects.back().b);
+
+        /* the first error is passed on to the caller */
+        sources[500] = { 'x' };
+        bool thrown = false;
+        try {
+            restore_batch<PSrl>(sources, restored, 4);
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown);
+
+        framed.pop_back();
+        thrown = false;
+        try {
+            restore_batch_framed<OrderA, PJson>(framed.data(), framed.size());
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+template<class TParser>
+bool parallel_loading()
+{
+    vector<OrderA> objects(300);
+    for(auto i = 0U; i < objects.size(); i++) {
+        objects[i].a = i;
+        objects[i].b = "[\"{" + to_string(i) + "},";
+        objects[i].c.resize(i % 7);
+    }
+
+    auto source = Tree().store<TParser>(objects);
+
+    auto restored = restore_parallel<OrderB, TParser>(source, 4);
+    if(restored.size() != objects.size()) {
+        return false;
+    }
+    for(auto i = 0U; i < objects.size(); i++) {
+        if(restored[i].a != objects[i].a || restored[i].b != objects[i].b || restored[i].c != objects[i].c) {
+            return false;
+        }
+    }
+
+    Tree serial, parallel;
+    serial.load_source(source, TParser());
+    parallel.load_source_parallel(source, TParser(), 4);
+
+    return parallel.root().num_nodes() == objects.size()
+        && parallel.to_source<PJson>() == serial.to_source<PJson>();
+}
+
+bool test_parallel_loading()
+{
+    const string SCOPE = "Loading arrays in parallel";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        TEST(parallel_loading<PSrl>());
+        TEST(parallel_loading<PJson>());
+        TEST(parallel_loading<PMsgPack>());
+
+        /* type ids are shared between elements */
+        vector<unique_ptr<Base>> bases;
+        for(auto i = 0; i < 100; i++) {
+            bases.emplace_back(i % 3 ? (Base*)new DerivedA(i) : new DerivedB(i));
+        }
+        auto restored = restore_parallel<unique_ptr<Base>, PSrl>(Tree().store<PSrl>(bases), 3);
+        for(auto i = 0; i < 100; i++) {
+            TEST(restored[i]->get() == i && restored[i]->srl_type_id().name() == bases[i]->srl_type_id().name());
+        }
+
+        /* pointees shared across elements are only stored with their first reference */
+        vector<shared_ptr<OrderA>> shared(60);
+        for(auto i = 0U; i < shared.size(); i++) {
+            shared[i] = i % 20 == 0 ? make_shared<OrderA>() : shared[i - 1];
+            shared[i]->a = i / 20;
+        }
+        auto restored_shared = restore_parallel<shared_ptr<OrderA>, PSrl>(Tree().store<PSrl>(shared), 3);
+        TEST(restored_shared.size() == shared.size());
+        for(auto i = 0U; i < shared.size(); i++) {
+            TEST(restored_shared[i]->a == shared[i]->a && restored_shared[i] == restored_shared[i - i % 20]);
+        }
+
+        string json = "[ /* ] */ { \"a\": 1, \"b\": \"x]}\\\"\", \"c\": [], \"d\": 0 }, // ]\n"
+                      "  { \"d\": 1, \"c\": [2], \"b\": \"{\", \"a\": 2 } ]";
+        auto orders = restore_parallel<OrderB, PJson>(json, 2);
+        TEST(orders.size() == 2 && orders[0].b == "x]}\"" && orders[1].a == 2 && orders[1].c[0] == 2);
+
+        bool thrown = false;
+        try {
+            restore_parallel<OrderB, PJson>(Tree().store<PJson>(OrderA()), 2);
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_prefetch_streams()
+{
+    const string SCOPE = "Prefetching and write-behind streams";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        vector<OrderA> objects(500);
+        for(auto i = 0U; i < objects.size(); i++) {
+            objects[i].a = i;
+            objects[i].b = to_string(i);
+            objects[i].c.resize(i % 5, i);
+        }
+        auto expected = Tree().store<PJson>(objects);
+
+        /* small chunks, so both buffers are swapped many times per document */
+        stringstream strm;
+        {
+            WriteBehindStream out(strm, 64);
+            Tree().store<PJson>(objects, out);
+            TEST(strm.str() == string(expected.begin(), expected.end()));
+        }
+        strm.seekg(0);
+        PrefetchStream in(strm, 64);
+        auto restored = Tree().restore<vector<OrderB>, PJson>(in);
+        TEST(restored.size() == objects.size() && restored.back().b == objects.back().b);
+        TEST(restored[7].c == objects[7].c);
+
+        auto* file = tmpfile();
+        TEST(file);
+        auto fd = fileno(file);
+        {
+            WriteBehindStream out(fd);
+            Tree().store<PSrl>(objects, out);
+        }
+        lseek(fd, 0, SEEK_SET);
+        PrefetchStream file_in(fd, 100);
+        auto from_file = Tree().restore<vector<OrderB>, PSrl>(file_in);
+        fclose(file);
+        TEST(from_file.size() == objects.size() && from_file[499].a == 499);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_stats()
+{
+    const string SCOPE = "Instrumentation counters";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        stats(true);
+
+        auto source = Tree().store<PJson>(OrderA());
+        Tree().restore<OrderB, PJson>(source);
+
+        auto snapshot = stats(true);
+#ifdef SRL_INSTRUMENT
+        /* out of order restore, fields d and c get buffered while looking for a and c */
+        TEST(snapshot.parser_reads > 0 && snapshot.parser_writes > 0);
+        TEST(snapshot.fields_buffered >= 2 && snapshot.field_lookups >= 4);
+        TEST(snapshot.string_misses > 0 && snapshot.heap_segments > 0);
+#else
+        TEST(snapshot.parser_reads == 0 && snapshot.heap_segments == 0);
+#endif
+        TEST(stats().parser_reads == 0);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_indexed_access()
+{
+    const string SCOPE = "Indexed access";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        vector<int> ints(100);
+        for(auto i = 0U; i < ints.size(); i++) {
+            ints[i] = i;
+        }
+        Tree tree;
+        tree.load_object(ints);
+        auto& root = tree.root();
+
+        for(auto i = 0; i < 100; i++) {
+            TEST(root.value(i).unwrap<int>() == i);
+        }
+        for(auto i = 99; i >= 0; i -= 7) {
+            TEST(root.value(i).unwrap<int>() == i);
+        }
+        TEST(root.value(3).unwrap<int>() == 3 && root.value(97).unwrap<int>() == 97);
+
+        root.value(60);
+        root.remove_value(50);
+        TEST(root.value(60).unwrap<int>() == 61 && root.value(49).unwrap<int>() == 49);
+
+        auto copy = root;
+        TEST(copy.value(60).unwrap<int>() == 61 && copy.value(0).unwrap<int>() == 0);
+
+        root.insert(100);
+        TEST(root.value(98).unwrap<int>() == 99 && root.value(99).unwrap<int>() == 100);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_reserved_memory()
+{
+    const string SCOPE = "Reserved memory";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        map<string, vector<string>> data;
+        for(auto i = 0; i < 2000; i++) {
+            data["key " + to_string(i)] = { "a string longer than a few bytes " + to_string(i), "short" };
+        }
+        auto source = Tree().store<PSrl>(data);
+
+        Tree tree;
+        tree.reserve_memory(64 << 20);
+
+        for(auto round = 0; round < 2; round++) {
+            auto segments = heap_segments();
+            tree.load_source(source, PSrl());
+
+            /* the first segment taken from the range keeps growing in place */
+            TEST(heap_segments() - segments <= 4);
+            TEST(tree.to_source<PSrl>() == source);
+            TEST((tree.root().unwrap<map<string, vector<string>>>() == data));
+
+            tree.clear(0);
+        }
+
+        /* used up, segments are allocated as usual */
+        Tree small;
+        small.reserve_memory(4096);
+        small.load_source(source, PSrl());
+        TEST(small.to_source<PSrl>() == source);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_memory_stats()
+{
+    const string SCOPE = "Memory stats";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        map<string, vector<string>> data;
+        for(auto i = 0; i < 500; i++) {
+            data["key " + to_string(i)] = { "a string longer than a few bytes " + to_string(i), "short" };
+        }
+        auto source = Tree().store<PJson>(data);
+
+        const auto adds_up = [](const Lib::Heap::Stats& s) {
+            return s.used + s.free + s.wasted + s.untouched == s.reserved && s.used <= s.reserved;
+        };
+
+        Tree tree;
+        TEST(tree.memory_stats().reserved() == 0);
+
+        tree.load_source(source, PJson());
+        auto loaded = tree.memory_stats();
+
+        TEST(adds_up(loaded.nodes) && loaded.nodes.segments > 0 && loaded.nodes.used > source.size() / 2);
+        TEST(loaded.used() <= loaded.reserved() && loaded.reserved() >= loaded.nodes.reserved);
+
+        /* removed nodes go to the free lists */
+        for(auto i = 0; i < 100; i++) {
+            tree.root().remove_node((size_t)0);
+        }
+        auto removed = tree.memory_stats().nodes;
+        TEST(adds_up(removed) && removed.free > 0 && removed.used < loaded.nodes.used);
+        TEST(removed.reserved == loaded.nodes.reserved);
+
+        tree.clear();
+        auto cleared = tree.memory_stats().nodes;
+        TEST(cleared.reserved == loaded.nodes.reserved && cleared.free == 0 && cleared.wasted == 0);
+        TEST(cleared.used < 1024 && adds_up(cleared));
+
+        tree.clear(0);
+        TEST(tree.memory_stats().nodes.reserved < loaded.nodes.reserved);
+
+        /* shared pointers are tracked by address while storing */
+        vector<shared_ptr<int>> shared;
+        for(auto i = 0; i < 100; i++) {
+            shared.push_back(make_shared<int>(i));
+        }
+        tree.store<PSrl>(shared);
+
+        auto table = tree.memory_stats().shared_store;
+        TEST(table.entries == 100 && table.buckets >= 100 && table.longest_chain >= 1);
+        TEST(table.load_factor == (double)table.entries / table.buckets && adds_up(table.heap));
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct Refusing {
+    static int alive;
+    int value;
+
+    Refusing(int value_) : value(value_)
+    {
+        if(value < 0) {
+            throw Exception("Refusing negative values.");
+        }
+        alive++;
+    }
+
+    Refusing(const Refusing& o) : value(o.value) { alive++; }
+    ~Refusing() { alive--; }
+};
+
+int Refusing::alive = 0;
+
+bool test_flat_table()
+{
+    const string SCOPE = "Flat hash table";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        /* page aligned addresses as keys, their identity hashes share the lower bits */
+        Lib::FlatTable<size_t, string> table;
+        map<size_t, string> reference;
+
+        uint64_t rnd = 7;
+        const auto next = [&rnd] {
+            rnd = rnd * 6364136223846793005ULL + 1442695040888963407ULL;
+            return rnd >> 33;
+        };
+
+        for(auto i = 0; i < 50000; i++) {
+            auto key = (next() % 2000) << 12;
+            auto val = "value " + to_string(i);
+
+            switch(next() % 4) {
+                case 0 :
+                    TEST(table.insert(key, val).first == (reference.count(key) > 0));
+                    reference.insert({ key, val });
+                    break;
+                case 1 :
+                    table.upsert(key, val);
+                    reference[key] = val;
+                    break;
+                case 2 :
+                    table.remove(key);
+                    reference.erase(key);
+                    break;
+                case 3 : {
+                    auto extracted = table.extract(key);
+                    TEST(extracted.has_value() == (reference.count(key) > 0));
+                    TEST(!extracted || *extracted == reference[key]);
+                    reference.erase(key);
+                }
+            }
+        }
+
+        TEST(table.num_entries() == reference.size());
+        for(auto& entry : reference) {
+            auto* val = table.get(entry.first);
+            TEST(val && *val == entry.second);
+        }
+
+        table.remove_if([](const size_t& key, string&) { return key % (3 << 12) == 0; });
+        size_t n = 0;
+        for(auto entry : table) {
+            TEST(entry.first % (3 << 12) != 0 && reference[entry.first] == entry.second);
+            n++;
+        }
+        TEST(n == table.num_entries() && table.get(0) == nullptr);
+
+        auto stats = table.stats();
+        TEST(stats.load_factor <= 0.875 && stats.longest_chain < 8);
+
+        auto moved = move(table);
+        TEST(moved.num_entries() == n && table.num_entries() == 0 && !table.get(1 << 12));
+
+        moved.clear();
+        TEST(moved.num_entries() == 0 && moved.stats().buckets == stats.buckets);
+        TEST(!moved.insert(string("key").size(), "value").first);
+
+        /* a throwing value constructor leaves the slot free */
+        Lib::FlatTable<size_t, Refusing> refusing;
+        bool thrown = false;
+        try {
+            refusing.insert(1, -1);
+        } catch(Exception&) {
+            thrown = true;
+        }
+        TEST(thrown && refusing.num_entries() == 0 && !refusing.get(1));
+        TEST(!refusing.insert(1, 1).first && refusing.get(1)->value == 1);
+        refusing.clear();
+        TEST(Refusing::alive == 0);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_incremental_rehash()
+{
+    const string SCOPE = "Incremental rehashing";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        Lib::HTable<size_t, string> table { 16 };
+        table.incremental_rehash();
+        map<size_t, string> reference;
+
+        /* every insert and lookup while growing finds entries in either table */
+        for(auto i = 0U; i < 20000; i++) {
+            auto key = i * 7919 % 20011;
+            TEST(!table.insert(key, to_string(i)).first);
+            reference[key] = to_string(i);
+
+            if(i % 3 == 0) {
+                auto probe = (i / 2) * 7919 % 20011;
+                auto* val = table.get(probe);
+                TEST(val && *val == reference[probe]);
+            }
+            if(i % 5 == 0) {
+                auto removed = (i / 3) * 7919 % 20011;
+                TEST(table.extract(removed).has_value() == (reference.erase(removed) > 0));
+            }
+        }
+
+        size_t n = 0;
+        table.foreach([&](const size_t& key, string& val) {
+            TEST(reference[key] == val);
+            n++;
+        });
+        TEST(n == reference.size() && table.num_entries() == n);
+
+        table.remove_if([](const size_t& key, string&) { return key % 2 == 0; });
+        n = 0;
+        size_t kept = 0;
+        for(auto entry : table) {
+            TEST(entry.first % 2 == 1 && reference[entry.first] == entry.second);
+            kept = entry.first;
+            n++;
+        }
+        TEST(n == table.num_entries());
+
+        /* pre-sized tables don't grow */
+        Lib::HTable<size_t, int> sized;
+        sized.reserve(10000);
+        sized.insert(0, 0);
+        auto buckets = sized.stats().buckets;
+        for(auto i = 1; i < 10000; i++) {
+            sized.insert(i, i);
+        }
+        TEST(buckets >= 10000 && sized.stats().buckets == buckets);
+
+        /* filled ones are rehashed at once */
+        table.reserve(100000);
+        TEST(table.stats().buckets >= 100000 && table.num_entries() == n && *table.get(kept) == reference[kept]);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+bool test_concurrent_registration()
+{
+    const string SCOPE = "Registering types while restoring";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        auto source = Tree().store<PSrl>(TestClass(new DerivedB(12), new DerivedA(6)));
+        atomic<bool> done   { false };
+        atomic<bool> failed { false };
+
+        vector<thread> readers;
+        for(auto i = 0; i < 3; i++) {
+            readers.emplace_back([&] {
+                try {
+                    while(!done.load()) {
+                        auto cl = Tree().restore<TestClass, PSrl>(source);
+                        if(cl.one->get() != 12 || cl.two->get() != 6) {
+                            failed = true;
+                        }
+                    }
+                } catch(Exception&) {
+                    failed = true;
+                }
+            });
+        }
+
+        /* the ids are copied, they don't have to outlive the registration */
+        vector<size_t> slots;
+        for(auto i = 0; i < 500; i++) {
+            auto id = "Plugin" + to_string(i);
+            register_type<DerivedA>(id.c_str());
+            slots.push_back(Lib::registrations()->slot(String(id)));
+        }
+
+        done = true;
+        for(auto& reader : readers) {
+            reader.join();
+        }
+        TEST(!failed);
+
+        for(auto i = 0U; i < slots.size(); i++) {
+            TEST(Lib::registrations()->slot(String("Plugin" + to_string(i))) == slots[i]);
+            TEST(i == 0 || slots[i] == slots[i - 1] + 1);
+        }
+        TEST(Lib::registrations()->create<Root>(String("Plugin42"))->get() == 1);
+
+        auto hash = Lib::Aux::hash_literal("DerivedB", 8);
+        TEST(Lib::registrations()->slot(String("DerivedB"), hash) == Lib::registrations()->slot(String("DerivedB")));
+
+        bool duplicated = false;
+        try {
+            register_type<DerivedA>("Plugin7");
+        } catch(Exception&) {
+            duplicated = true;
+        }
+        TEST(duplicated);
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
+struct Schema {
+    int         request_id = 0;
+    string      customer_of_the_order;
+    vector<int> quantities;
+
+    SRL_FIELDS(Schema, request_id, customer_of_the_order, quantities)
+};
+
+bool test_interned_names()
+{
+    const string SCOPE = "Interned names";
+    print_log("\t" + SCOPE + "...");
+
+    try {
+        intern_fields<Schema>();
+        intern_names({ String("interned_label"), String(u16string(u"interned_utf16")) });
+
+        Schema schema;
+        schema.request_id            = 7;
+        schema.customer_of_the_order = "someone";
+        schema.quantities            = { 1, 2, 3 };
+        auto source = Tree().store<PJson>(schema);
+
+        Tree first, second;
+        first.load_source(source, PJson());
+        second.load_source(source, PJson());
+
+        /* both trees point to the same names, none of them copied them */
+        TEST(&first.root().value("request_id").name() == &second.root().value("request_id").name());
+        TEST(&first.root().node("quantities").name() == &second.root().node("quantities").name());
+        TEST(first.memory_stats().strings.entries == 0);
+
+        auto restored = Tree().restore<Schema, PJson>(source);
+        TEST(restored.request_id == 7 && restored.customer_of_the_order == "someone" && restored.quantities.size() == 3);
+
+        /* other names still go to the string table of the tree */
+        Tree tree;
+        tree.root().insert("interned_label", 1);
+        tree.root().insert(String(u16string(u"interned_utf16")), 2);
+        tree.root().insert("not_interned", 3);
+        TEST(tree.memory_stats().strings.entries == 1);
+        TEST(tree.root().value("interned_utf16").unwrap<int>() == 2);
+
+        atomic<bool> done   { false };
+        atomic<bool> failed { false };
+
+        vector<thread> readers;
+        for(auto i = 0; i < 2; i++) {
+            readers.emplace_back([&] {
+                try {
+                    while(!done.load()) {
+                        auto loaded = Tree().restore<Schema, PJson>(source);
+                        if(loaded.request_id != 7 || loaded.quantities.size() != 3) {
+                            failed = true;
+                        }
+                    }
+                } catch(Exception&) {
+                    failed = true;
+                }
+            });
+        }
+
+        vector<string> names;
+        for(auto i = 0; i < 300; i++) {
+            names.push_back("name" + to_string(i));
+        }
+        for(auto i = 0U; i < names.size(); i += 10) {
+            intern_names(vector<String>(names.begin() + i, names.begin() + i + 10));
+        }
+
+        done = true;
+        for(auto& reader : readers) {
+            reader.join();
+        }
+        TEST(!failed);
+
+        for(auto& name : names) {
+            auto hash = Lib::Aux::hash_fnc((const uint8_t*)name.data(), name.size());
+            TEST(Lib::interned_names()->find(Lib::MemBlock((const uint8_t*)name.data(), name.size()), hash));
+        }
+
+    } catch(Exception& ex) {
+        print_log(string(ex.what()) + "\n");
+        return false;
+    }
+
+    print_log("ok.\n");
+    return true;
+}
+
 bool Tests::test_misc()
 {
     print_log("\nTest misc\n");
@@ -473,6 +1782,22 @@ bool Tests::test_misc()
     success &= test_polymorphic_classes();
     success &= test_shared_references();
     success &= test_pointer_serializing();
+    success &= test_field_order();
+    success &= test_packed_arrays();
+    success &= test_reuse_objects();
+    success &= test_pmr_restore();
+    success &= test_string_views();
+    success &= test_batches();
+    success &= test_parallel_loading();
+    success &= test_prefetch_streams();
+    success &= test_stats();
+    success &= test_indexed_access();
+    success &= test_reserved_memory();
+    success &= test_memory_stats();
+    success &= test_flat_table();
+    success &= test_incremental_rehash();
+    success &= test_concurrent_registration();
+    success &= test_interned_names();
 
     return success;
 }
@@ -183,6 +183,7 @@ struct TestClassC {
     Srl::Lib::HTable<string, int>               hash_table_a;
     Srl::Lib::HTable<string, TestClassD>        hash_table_b;
     Srl::Lib::HTable<string, vector<int>>       hash_table_c;
+    Srl::Lib::FlatTable<string, vector<int>>    flat_table;
 
     set<string> set_string { "a" };
 
@@ -193,7 +194,8 @@ struct TestClassC {
             ("set_string", set_string)
             ("hash_table_a", hash_table_a)
             ("hash_table_b", hash_table_b)
-            ("hash_table_c", hash_table_c);
+            ("hash_table_c", hash_table_c)
+            ("flat_table", flat_table);
     }
 
     void srl_store(StoreContext& ctx) const
@@ -203,7 +205,8 @@ struct TestClassC {
             ("set_string", set_string)
             ("hash_table_a", hash_table_a)
             ("hash_table_b", hash_table_b)
-            ("hash_table_c", hash_table_c);
+            ("hash_table_c", hash_table_c)
+            ("flat_table", flat_table);
     }
 
     void shuffle()
@@ -211,6 +214,7 @@ struct TestClassC {
         this->hash_table_a.clear();
         this->hash_table_b.clear();
         this->hash_table_c.clear();
+        this->flat_table.clear();
         this->map_class.clear();
 
         for(auto i = 0; i < 3; i++) {
@@ -226,6 +230,7 @@ struct TestClassC {
             this->hash_table_a.insert(map_key, i);
             this->hash_table_b.insert(map_key, TestClassD());
             this->hash_table_c.insert(map_key, vec);
+            this->flat_table.insert(map_key, vec);
         }
 
         for(auto& e : this->map_class) {
@@ -256,6 +261,7 @@ struct TestClassC {
         TEST(this->hash_table_a.num_entries() == n.hash_table_a.num_entries());
         TEST(this->hash_table_b.num_entries() == n.hash_table_b.num_entries());
         TEST(this->hash_table_c.num_entries() == n.hash_table_c.num_entries());
+        TEST(this->flat_table.num_entries() == n.flat_table.num_entries());
 
         this->hash_table_a.foreach([&](const string& key, int& value)
         {
@@ -280,6 +286,13 @@ struct TestClassC {
                 TEST(n_entry->at(i) == value.at(i));
             }
         });
+
+        this->flat_table.foreach([&](const string& key, vector<int>& value)
+        {
+            auto* n_entry = n.flat_table.get(key);
+            TEST(n_entry != nullptr);
+            TEST(*n_entry == value);
+        });
     }
 };
 
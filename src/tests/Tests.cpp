@@ -20,7 +20,6 @@ bool Tests::Run_Benchmarks         = false;
 size_t Tests::Benchmark_Objects    = 10000;
 size_t Tests::Benchmark_Iterations = 1;
 
-
 void Tests::print_source(const vector<uint8_t>& source)
 {
     for(auto c : source) {
@@ -68,7 +67,9 @@ int main(int argc, char** args)
     } else {
         bool success = Tests::test_parser() &&
                        Tests::test_malicious_input() &&
-                       Tests::test_misc();
+                       Tests::test_misc() &&
+                       Tests::test_complexity() &&
+                       Tests::test_allocations();
 
         cout<<endl;
         if(success) {
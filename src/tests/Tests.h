@@ -20,12 +20,22 @@ namespace Tests {
 
     void print_log(const std::string& message);
 
+    /* totals of operator new calls and bytes requested so far */
+    size_t allocations();
+    size_t allocated_bytes();
+    /* heap segments allocated by the calling thread, counted with SRL_INSTRUMENT only */
+    size_t heap_segments();
+
     bool test_parser();
 
     bool test_misc();
 
     bool test_malicious_input();
 
+    bool test_complexity();
+
+    bool test_allocations();
+
     void run_benches();
 }
 